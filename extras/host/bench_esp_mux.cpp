@@ -0,0 +1,76 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Host benchmark of the ESP8266 os_timer multiplexer (ESPTimer with USING_ESP_TIMER_MUX) against the stubbed core in stub/,
+built twice: as bench_esp_mux with the multiplexer, and as bench_esp_os with an os_timer per ESPTimer
+
+SYST_ESP_MUX_TIMERS timers run for 10 sec of simulated time, first as one-shots that re-arm themselves from their
+callbacks and then as repeating timers. For each, the os_timer_arm() calls are counted, with the armed timers the SDK
+steps past to insert a timer in its sorted timer list (which it also does to re-insert a repeating timer when it
+expires), along with the host time per callback
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysTimer.h>
+#include <stdio.h>
+#include <chrono>
+
+#define BENCH_TIMERS   SYST_ESP_MUX_TIMERS
+#define BENCH_USEC     10000000UL                   // simulated run time
+
+static ESPTimer _timers[BENCH_TIMERS];
+static uint32_t _calls = 0;
+
+static void count(void* arg) {
+   (void)arg;
+   ++_calls;
+}
+
+static void rearm(void* arg) {
+   ++_calls;
+   static_cast<ESPTimer*>(arg)->arm(false);
+}
+
+static void run(const char* name, const bool repeat) {
+   for (uint16_t i = 0; i < BENCH_TIMERS; i++) {
+      _timers[i].disarm();
+   }
+   stubAdvance(1000000);                             // let the multiplexer drop them
+   stubReset();
+   _calls = 0;
+   for (uint16_t i = 0; i < BENCH_TIMERS; i++) {
+      _timers[i].setInterval(5 + ((i * 7) % 40));    // 5 - 44 msec, so deadlines coincide only now and then
+      _timers[i].attachInterrupt(repeat ? count : rearm, &_timers[i]);
+      _timers[i].arm(repeat);
+   }
+
+   uint32_t armsAtStart = stubStats.osTimerArms;
+   uint32_t walkedAtStart = stubStats.osTimerWalked;
+   auto     start = std::chrono::steady_clock::now();
+
+   stubAdvance(BENCH_USEC);
+
+   auto     elapsed = std::chrono::steady_clock::now() - start;
+   uint32_t arms = stubStats.osTimerArms - armsAtStart;
+   uint32_t walked = stubStats.osTimerWalked - walkedAtStart;
+   double   nsec = std::chrono::duration<double, std::nano>(elapsed).count();
+
+#ifdef USING_ESP_TIMER_MUX
+   const char* mode = "mux";
+#else
+   const char* mode = "os_timer each";
+#endif
+   printf("%-14s %-26s %7u callbacks %7u os_timer_arm %6.3f arms/cb %9u walked %7.2f walked/cb %7.1f ns/cb\n", mode,
+          name, static_cast<unsigned>(_calls), static_cast<unsigned>(arms), static_cast<double>(arms) / _calls,
+          static_cast<unsigned>(walked), static_cast<double>(walked) / _calls, nsec / _calls);
+}
+
+int main(void) {
+   run("one-shots re-armed in cb", false);
+   run("repeating", true);
+   return 0;
+}
@@ -0,0 +1,123 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Host benchmark of the clock reads made by the ESP8266 timer handlers, against the stubbed core in stub/
+
+the stub counts every micros() and millis() call, and stubReadCost makes the simulated clock advance on each one,
+which stands in for the cost of a read on the target. For each handler this prints the reads per pass and per
+callback, and for FRC1 how late the callbacks were on average
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysTimer.h>
+#include <stdio.h>
+
+#define MUX_TIMERS     32
+
+static ESPTimer   _mux[MUX_TIMERS];
+static ESPHWTimer _hw[SYST_ESP_HW_TIMERS];
+
+static uint32_t   _calls = 0;
+static uint32_t   _passes = 0;
+static uint32_t   _first[SYST_ESP_HW_TIMERS];        // usec value of the first deadline
+static uint32_t   _fired[SYST_ESP_HW_TIMERS];        // fire count before the run
+static uint64_t   _late = 0;                         // usec, summed over the callbacks
+
+static void muxCount(void* arg) {
+   if (arg == &_mux[0]) {
+      ++_passes;                                     // every timer is due in every pass, and the first one is called first
+   }
+   ++_calls;
+}
+
+static void hwCount(void* arg) {
+   ESPHWTimer* that = static_cast<ESPHWTimer*>(arg);
+   uint8_t     i = that - _hw;
+   uint32_t    due = _first[i] + ((that->getFireCount() - _fired[i] - 1) * that->getIntervalMicros());
+
+   ++_calls;
+   _late += stubNow() - due;
+}
+
+static void report(const char* name, const uint32_t passes, const bool late) {
+   uint32_t reads = stubStats.microsReads + stubStats.millisReads;
+
+   printf("%-36s %6u passes %7u callbacks %5.2f reads/pass %5.2f reads/callback", name, static_cast<unsigned>(passes),
+          static_cast<unsigned>(_calls), static_cast<double>(reads) / passes, static_cast<double>(reads) / _calls);
+   if (late) {
+      printf(" %5.2f usec late", static_cast<double>(_late) / _calls);
+   }
+   printf("\n");
+}
+
+// MUX_TIMERS os_timer timers due together every 10 msec, for 1 sec
+static void runMux(const uint32_t readCost) {
+   char name[40];
+
+   for (uint8_t i = 0; i < MUX_TIMERS; i++) {
+      _mux[i].disarm();
+   }
+   stubAdvance(1000000);
+   stubReset();
+   for (uint8_t i = 0; i < MUX_TIMERS; i++) {
+      _mux[i].setInterval(10);
+      _mux[i].attachInterrupt(muxCount, &_mux[i]);
+      _mux[i].arm(true);
+   }
+   _calls = _passes = 0;
+   _late = 0;
+   stubStats.microsReads = stubStats.millisReads = 0;
+   stubReadCost = readCost;
+   stubAdvance(1000000);
+   stubReadCost = 0;
+   snprintf(name, sizeof(name), "mux, %u timers, %u usec/read", MUX_TIMERS, static_cast<unsigned>(readCost));
+   report(name, _passes, false);
+}
+
+/*
+FRC1 timers every 100 usec for 100 msec: with spread set, each pair is due 3 usec after the one before, so every
+pass also waits for the next deadline in the spin loop. The clock only moves in the spin loop if reading it takes
+time, so that case needs a read cost
+*/
+static void runHW(const bool spread, const uint32_t readCost) {
+   char name[40];
+
+   for (uint8_t i = 0; i < SYST_ESP_HW_TIMERS; i++) {
+      _hw[i].disarm();
+   }
+   stubReset();
+   for (uint8_t i = 0; i < SYST_ESP_HW_TIMERS; i++) {
+      _hw[i].setIntervalMicros(100);
+      _hw[i].attachInterrupt(hwCount, &_hw[i]);
+      _first[i] = stubNow() + 100;
+      _fired[i] = _hw[i].getFireCount();
+      _hw[i].arm(true);
+      if (spread && ((i % 2) == 1)) {
+         stubAdvance(3);
+      }
+   }
+   _calls = 0;
+   _late = 0;
+   stubStats.microsReads = stubStats.millisReads = 0;
+   stubStats.frc1Interrupts = 0;
+   stubReadCost = readCost;
+   stubAdvance(100000);
+   stubReadCost = 0;
+   snprintf(name, sizeof(name), "FRC1, %s, %u usec/read", spread ? "pairs 3 usec apart" : "all together",
+            static_cast<unsigned>(readCost));
+   report(name, stubStats.frc1Interrupts, true);
+}
+
+int main(void) {
+   runMux(0);
+   runMux(1);
+   runHW(false, 0);
+   runHW(false, 1);
+   runHW(true, 1);
+   runHW(true, 2);
+   return 0;
+}
@@ -0,0 +1,111 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Host stub of the parts of the ESP8266 Arduino core that SysTimer_ESP.cpp and the timer engines use, so they can be
+built and tested on the host (see extras/host/Makefile)
+
+the clock is simulated and only moves when the test calls stubAdvance() (or the code under test calls
+delayMicroseconds()), and the FRC1 timer and the SDK os_timers expire from there. The interrupt level is tracked, so an FRC1 interrupt is held off while the level is raised and is
+taken as soon as it is lowered, and also just before the level is raised from 0 (i.e. in the window before a
+critical section)
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysTimer_stub_arduino_H_
+#define _SysTimer_stub_arduino_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#define ICACHE_RAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define bit(b)                    (1UL << (b))
+
+uint32_t micros(void);
+uint32_t millis(void);
+void     delayMicroseconds(const uint32_t usec);    // advances the simulated clock
+
+// GPIO: GPOS and GPOC set and clear output bits, and every change to the outputs is logged with the time
+#define INPUT         0x00
+#define OUTPUT        0x01
+#define INPUT_PULLUP  0x02
+#define LOW           0x0
+#define HIGH          0x1
+
+struct StubGPIOWrite {
+   const bool set;
+   StubGPIOWrite& operator=(const uint32_t mask);
+};
+
+extern StubGPIOWrite     GPOS;
+extern StubGPIOWrite     GPOC;
+extern volatile uint32_t GPI;                        // input levels, set by the test
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+void     noInterrupts(void);
+void     interrupts(void);
+uint32_t xt_rsil(const uint32_t level);
+void     xt_wsr_ps(const uint32_t ps);
+
+// FRC1 (timer1)
+#define TIM_DIV1     0
+#define TIM_DIV16    1
+#define TIM_DIV256   3
+#define TIM_EDGE     0
+#define TIM_LEVEL    1
+#define TIM_SINGLE   0
+#define TIM_LOOP     1
+
+typedef void (*timercallback)(void);
+
+void timer1_isr_init(void);
+void timer1_attachInterrupt(timercallback userFunc);
+void timer1_enable(uint8_t divider, uint8_t int_type, uint8_t reload);
+void timer1_write(uint32_t ticks);
+void timer1_disable(void);
+
+// test control and instrumentation
+struct StubStats {
+   uint32_t microsReads;          // micros() calls
+   uint32_t millisReads;          // millis() calls
+   uint32_t osTimerArms;          // os_timer_arm() calls
+   uint32_t osTimerWalked;        // armed timers the SDK steps past to insert a timer in its sorted list, on arm or repeat
+   uint32_t osTimerDisarms;       // os_timer_disarm() calls
+   uint32_t frc1Writes;           // timer1_write() calls
+   uint32_t frc1Interrupts;       // FRC1 interrupts taken
+   uint32_t interruptsInISR;      // interrupts() or a level of 0 restored while in an interrupt handler
+};
+
+// a change to the GPIO outputs
+struct StubEdge {
+   uint32_t time;                 // simulated usec
+   uint32_t pins;                 // output levels from then on
+};
+
+#define STUB_EDGES   4096
+
+extern StubStats stubStats;
+extern uint32_t  stubLevel;            // current interrupt level, 0 = enabled
+extern uint32_t  stubReadCost;         // usec the clock advances on each micros() or millis() read (default 0)
+
+void     stubReset(void);
+void     stubAdvance(const uint32_t usec);    // run the simulated clock forward, taking any interrupts and os_timer callbacks that are due
+void     stubRaiseFRC1(void);                  // make an FRC1 interrupt pending now, whatever FRC1 is loaded with
+uint32_t stubNow(void);                        // simulated time in usec, without counting as a read
+bool     stubFRC1Loaded(void);                 // FRC1 is enabled and counting down
+uint32_t stubFRC1Remaining(void);              // usec until the FRC1 interrupt
+
+extern uint32_t stubPins;                      // GPIO output levels
+extern StubEdge stubEdges[STUB_EDGES];         // GPIO output changes since stubReset(), oldest first
+extern uint16_t stubEdgeCount;                 // stops counting when the log is full
+bool     stubPinAt(const uint8_t pin, const uint32_t usec);   // level of an output at a time covered by the log
+
+#endif
@@ -0,0 +1,254 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Host stub of the ESP8266 core and SDK calls (see arduino.h)
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include "arduino.h"
+extern "C" {
+   #include "user_interface.h"             // the SDK calls have C linkage, as SysTimer.h declares them
+}
+
+#include <string.h>
+
+StubStats stubStats;
+uint32_t  stubLevel = 0;
+uint32_t  stubReadCost = 0;
+
+static uint64_t      _now = 0;                  // simulated usec
+static uint32_t      _inISR = 0;                // nesting depth of FRC1 interrupts
+
+static timercallback _frc1Handler = nullptr;
+static bool          _frc1Enabled = false;
+static bool          _frc1Loaded = false;
+static bool          _frc1Pending = false;
+static uint64_t      _frc1Due = 0;
+
+static os_timer_t*   _osTimers = nullptr;
+
+StubGPIOWrite     GPOS = { true };
+StubGPIOWrite     GPOC = { false };
+volatile uint32_t GPI = 0;
+uint32_t          stubPins = 0;
+StubEdge          stubEdges[STUB_EDGES];
+uint16_t          stubEdgeCount = 0;
+static uint32_t   _pinsAtReset = 0;
+
+// take a pending FRC1 interrupt if interrupts are enabled
+static void takeFRC1(void) {
+   if (_frc1Pending && (stubLevel == 0) && (_frc1Handler != nullptr)) {
+      _frc1Pending = false;
+      ++stubStats.frc1Interrupts;
+      ++_inISR;
+      stubLevel = 1;
+      (*_frc1Handler)();
+      stubLevel = 0;
+      --_inISR;
+   }
+}
+
+uint32_t micros(void) {
+   uint32_t now = static_cast<uint32_t>(_now);
+
+   ++stubStats.microsReads;
+   _now += stubReadCost;
+   return now;
+}
+
+uint32_t millis(void) {
+   uint32_t now = static_cast<uint32_t>(_now / 1000);
+
+   ++stubStats.millisReads;
+   _now += stubReadCost;
+   return now;
+}
+
+void delayMicroseconds(const uint32_t usec) {
+   _now += usec;
+}
+
+static void setPins(const uint32_t pins) {
+   if ((pins != stubPins) && (stubEdgeCount < STUB_EDGES)) {
+      stubEdges[stubEdgeCount].time = static_cast<uint32_t>(_now);
+      stubEdges[stubEdgeCount].pins = pins;
+      ++stubEdgeCount;
+   }
+   stubPins = pins;
+}
+
+StubGPIOWrite& StubGPIOWrite::operator=(const uint32_t mask) {
+   setPins(set ? (stubPins | mask) : (stubPins & ~mask));
+   return *this;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+   (void)pin;
+   (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+   setPins((value != LOW) ? (stubPins | (1UL << pin)) : (stubPins & ~(1UL << pin)));
+}
+
+bool stubPinAt(const uint8_t pin, const uint32_t usec) {
+   uint32_t pins = _pinsAtReset;
+
+   for (uint16_t i = 0; (i < stubEdgeCount) && (static_cast<int32_t>(usec - stubEdges[i].time) >= 0); i++) {
+      pins = stubEdges[i].pins;
+   }
+   return (pins & (1UL << pin)) != 0;
+}
+
+uint32_t xt_rsil(const uint32_t level) {
+   uint32_t saved;
+
+   takeFRC1();                                   // an interrupt may arrive just before the level is raised
+   saved = stubLevel;
+   stubLevel = level;
+   return saved;
+}
+
+void xt_wsr_ps(const uint32_t ps) {
+   stubLevel = ps;
+   if ((ps == 0) && (_inISR > 0)) {
+      ++stubStats.interruptsInISR;
+   }
+   takeFRC1();
+}
+
+void noInterrupts(void) {
+   (void)xt_rsil(15);
+}
+
+void interrupts(void) {
+   xt_wsr_ps(0);
+}
+
+void timer1_isr_init(void) {
+}
+
+void timer1_attachInterrupt(timercallback userFunc) {
+   _frc1Handler = userFunc;
+}
+
+void timer1_enable(uint8_t divider, uint8_t int_type, uint8_t reload) {
+   (void)divider;
+   (void)int_type;
+   (void)reload;
+   _frc1Enabled = true;
+}
+
+// TIM_DIV16 on the 80MHz APB clock counts 5 ticks per usec
+void timer1_write(uint32_t ticks) {
+   ++stubStats.frc1Writes;
+   _frc1Due = _now + (ticks / 5);
+   _frc1Loaded = _frc1Enabled;
+}
+
+void timer1_disable(void) {
+   _frc1Enabled = false;
+   _frc1Loaded = false;
+}
+
+void os_timer_setfn(os_timer_t* ptimer, ETSTimerFunc* pfunction, void* parg) {
+   ptimer->func = pfunction;
+   ptimer->arg = parg;
+   ptimer->armed = false;
+}
+
+// the SDK keeps armed timers in a list sorted by expiry, so inserting one steps past those due no later
+static void countWalk(const os_timer_t* ptimer) {
+   for (os_timer_t* t = _osTimers; t != nullptr; t = t->next) {
+      if ((t != ptimer) && t->armed && (t->due <= ptimer->due)) {
+         ++stubStats.osTimerWalked;
+      }
+   }
+}
+
+void os_timer_arm(os_timer_t* ptimer, uint32_t msec, bool repeat) {
+   ++stubStats.osTimerArms;
+   ptimer->armed = false;
+   ptimer->repeat = repeat;
+   ptimer->period = msec;
+   ptimer->due = _now + (static_cast<uint64_t>(msec) * 1000);
+   countWalk(ptimer);
+   ptimer->armed = true;
+   for (os_timer_t* t = _osTimers; t != nullptr; t = t->next) {
+      if (t == ptimer) {
+         return;
+      }
+   }
+   ptimer->next = _osTimers;
+   _osTimers = ptimer;
+}
+
+void os_timer_disarm(os_timer_t* ptimer) {
+   ++stubStats.osTimerDisarms;
+   ptimer->armed = false;
+}
+
+void stubReset(void) {
+   memset(&stubStats, 0, sizeof(stubStats));
+   stubEdgeCount = 0;
+   _pinsAtReset = stubPins;
+   stubLevel = 0;
+   stubReadCost = 0;
+   _frc1Pending = false;
+   _frc1Loaded = false;
+   for (os_timer_t* t = _osTimers; t != nullptr; t = t->next) {
+      t->armed = false;
+   }
+}
+
+void stubAdvance(const uint32_t usec) {
+   uint64_t target = _now + usec;
+
+   while (true) {
+      os_timer_t* first = nullptr;
+      for (os_timer_t* t = _osTimers; t != nullptr; t = t->next) {
+         if (t->armed && (t->due <= target) && ((first == nullptr) || (t->due < first->due))) {
+            first = t;
+         }
+      }
+      bool frc1 = _frc1Loaded && (_frc1Due <= target) && ((first == nullptr) || (_frc1Due <= first->due));
+      if (frc1) {
+         _now = (_frc1Due > _now) ? _frc1Due : _now;
+         _frc1Loaded = false;                                      // TIM_SINGLE
+         _frc1Pending = true;
+         takeFRC1();
+      } else if (first != nullptr) {
+         _now = (first->due > _now) ? first->due : _now;
+         if (first->repeat) {
+            first->due += static_cast<uint64_t>(first->period) * 1000;
+            countWalk(first);                                      // the SDK re-inserts a repeating timer
+         } else {
+            first->armed = false;
+         }
+         (*first->func)(first->arg);
+      } else {
+         break;
+      }
+   }
+   _now = (target > _now) ? target : _now;
+}
+
+void stubRaiseFRC1(void) {
+   _frc1Pending = true;
+}
+
+uint32_t stubNow(void) {
+   return static_cast<uint32_t>(_now);
+}
+
+bool stubFRC1Loaded(void) {
+   return _frc1Loaded;
+}
+
+uint32_t stubFRC1Remaining(void) {
+   return _frc1Loaded ? static_cast<uint32_t>(_frc1Due - _now) : 0;
+}
@@ -0,0 +1,33 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Host stub of the ESP8266 SDK os_timer calls (see arduino.h)
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysTimer_stub_user_interface_H_
+#define _SysTimer_stub_user_interface_H_
+
+#include <stdint.h>
+
+typedef void ETSTimerFunc(void* timer_arg);
+
+typedef struct _os_timer_t {
+   ETSTimerFunc* func;
+   void*         arg;
+   bool          armed;
+   bool          repeat;
+   uint32_t      period;                // msec
+   uint64_t      due;                   // simulated usec
+   struct _os_timer_t* next;            // list of timers that have ever been armed, so they must outlive the test
+} os_timer_t;
+
+void os_timer_setfn(os_timer_t* ptimer, ETSTimerFunc* pfunction, void* parg);
+void os_timer_arm(os_timer_t* ptimer, uint32_t msec, bool repeat);
+void os_timer_disarm(os_timer_t* ptimer);
+
+#endif
@@ -0,0 +1,155 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Host test of SysBitBangTX against the stubbed core in stub/: the waveform is rebuilt from the GPIO edge log
+
+built with USING_ESP_HW_TIMER to check the UART and SPI frames and bit times, and without it to check that the
+os_timer, which only has msec resolution, is refused
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysBitBangTX.h>
+#include <stdio.h>
+
+static int _failures = 0;
+
+#define CHECK(cond) \
+   do { \
+      if (!(cond)) { \
+         printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+         ++_failures; \
+      } \
+   } while (0)
+
+#define TX_PIN      4
+#define CLOCK_PIN   5
+
+static SysTimer     txTimer;
+static SysBitBangTX tx(txTimer);
+
+#ifdef USING_ESP_HW_TIMER
+
+static const uint8_t _bytes[] = { 0x55, 0xA3, 0x00, 0xFF };
+
+// the first edge after stubReset() that sets the pin to level, or -1
+static int16_t findEdge(const uint8_t pin, const bool level, const uint16_t from) {
+   for (uint16_t i = from; i < stubEdgeCount; i++) {
+      bool before = (i == 0) ? !level : ((stubEdges[i - 1].pins & (1UL << pin)) != 0);
+      if ((((stubEdges[i].pins & (1UL << pin)) != 0) == level) && (before != level)) {
+         return i;
+      }
+   }
+   return -1;
+}
+
+/*
+9600 baud is a 104 usec bit: each frame is a start bit (low), the data bits LSB first and a stop bit (high), sent back
+to back, and every edge is on a bit boundary
+*/
+static void testUART(void) {
+   stubReset();
+   CHECK(tx.beginUART(TX_PIN, 9600));
+   CHECK(stubPinAt(TX_PIN, stubNow()));                    // idles high
+   CHECK(tx.write(_bytes, sizeof(_bytes)) == sizeof(_bytes));
+   CHECK(tx.busy());
+
+   uint32_t armed = stubNow();
+   stubAdvance(sizeof(_bytes) * 10 * 104 + 1000);
+   CHECK(!tx.busy());
+   CHECK(!txTimer.armed());
+
+   int16_t first = findEdge(TX_PIN, false, 0);
+   CHECK(first >= 0);
+   if (first < 0) {
+      return;
+   }
+   uint32_t start = stubEdges[first].time;
+   CHECK(start == (armed + 104));
+   for (uint16_t i = first; i < stubEdgeCount; i++) {
+      CHECK(((stubEdges[i].time - start) % 104) == 0);
+   }
+   for (uint8_t b = 0; b < sizeof(_bytes); b++) {
+      uint32_t frame = start + (b * 10 * 104);
+      uint8_t  value = 0;
+
+      CHECK(!stubPinAt(TX_PIN, frame + 52));                // start bit
+      for (uint8_t bit = 0; bit < 8; bit++) {
+         if (stubPinAt(TX_PIN, frame + ((bit + 1) * 104) + 52)) {
+            value |= 1 << bit;
+         }
+      }
+      CHECK(value == _bytes[b]);
+      CHECK(stubPinAt(TX_PIN, frame + (9 * 104) + 52));     // stop bit
+   }
+   CHECK(stubPinAt(TX_PIN, stubNow()));                    // left idle high
+   tx.end();
+}
+
+/*
+10 kbit/s is a 50 usec tick: the data bit is set with the clock low and sampled on the rising edge, MSB first, with a
+100 usec clock period
+*/
+static void testSPI(void) {
+   stubReset();
+   CHECK(tx.beginSPI(TX_PIN, CLOCK_PIN, 10000));
+   CHECK(tx.write(_bytes, sizeof(_bytes)) == sizeof(_bytes));
+   stubAdvance(sizeof(_bytes) * 16 * 50 + 1000);
+   CHECK(!tx.busy());
+   CHECK(!stubPinAt(CLOCK_PIN, stubNow()));                // clock idles low
+
+   uint16_t edge = 0;
+   uint32_t lastRise = 0;
+   uint16_t rises = 0;
+
+   for (uint8_t b = 0; b < sizeof(_bytes); b++) {
+      uint8_t value = 0;
+      for (uint8_t bit = 0; bit < 8; bit++) {
+         int16_t rise = findEdge(CLOCK_PIN, true, edge);
+         CHECK(rise >= 0);
+         if (rise < 0) {
+            return;
+         }
+         uint32_t time = stubEdges[rise].time;
+         if (rises > 0) {
+            CHECK((time - lastRise) == 100);
+         }
+         CHECK(stubPinAt(CLOCK_PIN, time - 25) == false);  // the clock was low for the first half of the bit
+         value = (value << 1) | (stubPinAt(TX_PIN, time) ? 1 : 0);
+         lastRise = time;
+         ++rises;
+         edge = rise + 1;
+      }
+      CHECK(value == _bytes[b]);
+   }
+   CHECK(findEdge(CLOCK_PIN, true, edge) < 0);             // no extra clocks
+   tx.end();
+}
+
+int main(void) {
+   testUART();
+   testSPI();
+   if (_failures == 0) {
+      printf("test_bitbang_tx: all tests passed\n");
+   }
+   return (_failures == 0) ? 0 : 1;
+}
+
+#else
+
+// the os_timer rounds to whole msec, so it cannot clock the line
+int main(void) {
+   stubReset();
+   CHECK(!tx.beginUART(TX_PIN, 9600));
+   CHECK(!tx.beginSPI(TX_PIN, CLOCK_PIN, 10000));
+   CHECK(!tx.write(0x55));
+   if (_failures == 0) {
+      printf("test_bitbang_tx_os: all tests passed\n");
+   }
+   return (_failures == 0) ? 0 : 1;
+}
+
+#endif
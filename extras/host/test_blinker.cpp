@@ -0,0 +1,121 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Host test of SysBlinker against the stubbed core in stub/: the callback is run tick by tick and the LED pins are
+compared with the original definition of a pattern, under which an LED steps on the ticks that are a multiple of
+(1 << shift) and shows bit ((tick >> shift) & 31) of its pattern
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysBlinker.h>
+#include <stdio.h>
+
+void _SysBlinkerHandler(void* arg);
+
+static int _failures = 0;
+
+#define CHECK(cond) \
+   do { \
+      if (!(cond)) { \
+         printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+         ++_failures; \
+      } \
+   } while (0)
+
+#define LEDS        8
+#define TICKS       5000
+
+static const uint8_t _pins[LEDS] = { 0, 2, 4, 5, 12, 13, 14, 15 };
+static const uint8_t _shifts[LEDS] = { 0, 1, 2, 3, 0, 5, 1, 4 };
+
+static SysTimer    blinkTimer;
+static SysBlinkLED leds[LEDS];
+static SysBlinker  blinker(blinkTimer, leds, LEDS);
+
+// the original per-step definition
+struct Reference {
+   uint32_t pattern;
+   uint8_t  shift;
+   bool     level;
+};
+
+static Reference _ref[LEDS];
+static uint32_t  _seed = 12345;
+
+static uint32_t random32(void) {
+   _seed = _seed * 1664525UL + 1013904223UL;
+   return _seed;
+}
+
+static void referenceTick(const uint32_t tick) {
+   for (uint8_t i = 0; i < LEDS; i++) {
+      uint32_t steps = tick >> _ref[i].shift;
+
+      if ((steps << _ref[i].shift) == tick) {
+         _ref[i].level = (_ref[i].pattern >> (steps & 0x1F)) & 0x01;
+      }
+   }
+}
+
+// run the callback for count ticks from tick, changing an LED's pattern every so often, and compare every pin on every tick
+static uint16_t run(uint32_t tick, const uint16_t count) {
+   uint16_t mismatches = 0;
+
+   for (uint16_t n = 0; n < count; n++, tick++) {
+      if ((n % 97) == 96) {
+         uint8_t  i = random32() % LEDS;
+         uint32_t pattern = random32();
+         uint8_t  shift = random32() % 6;
+
+         CHECK(blinker.setPattern(i, pattern, shift));
+         CHECK(blinker.getPattern(i) == pattern);
+         _ref[i].pattern = pattern;
+         _ref[i].shift = shift;
+      }
+      _SysBlinkerHandler(&blinker);
+      referenceTick(tick);
+      for (uint8_t i = 0; i < LEDS; i++) {
+         if (((stubPins >> _pins[i]) & 0x01) != _ref[i].level) {
+            ++mismatches;
+         }
+      }
+   }
+   return mismatches;
+}
+
+// patterns attached before begin() start from step 0
+static void testSteps(void) {
+   stubReset();
+   for (uint8_t i = 0; i < LEDS; i++) {
+      _ref[i].pattern = random32();
+      _ref[i].shift = _shifts[i];
+      _ref[i].level = false;
+      CHECK(blinker.attach(_pins[i], _ref[i].pattern, _ref[i].shift) == i);
+      CHECK(blinker.getPattern(i) == _ref[i].pattern);
+   }
+   CHECK(blinker.begin());
+   CHECK(run(0, TICKS) == 0);
+   for (uint8_t i = 0; i < LEDS; i++) {
+      CHECK(blinker.getPattern(i) == _ref[i].pattern);
+   }
+}
+
+// begin() again restarts every pattern from step 0, whatever step it had reached
+static void testRestart(void) {
+   CHECK(blinker.begin());
+   CHECK(run(0, TICKS) == 0);
+   blinker.end();
+}
+
+int main(void) {
+   testSteps();
+   testRestart();
+   if (_failures == 0) {
+      printf("test_blinker: all tests passed\n");
+   }
+   return (_failures == 0) ? 0 : 1;
+}
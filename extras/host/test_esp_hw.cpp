@@ -0,0 +1,227 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Host test of the ESP8266 FRC1 backend (ESPHWTimer) against the stubbed core in stub/
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysTimer.h>
+#include <stdio.h>
+
+static int _failures = 0;
+
+#define CHECK(cond) \
+   do { \
+      if (!(cond)) { \
+         printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+         ++_failures; \
+      } \
+   } while (0)
+
+static ESPHWTimer timerA;
+static ESPHWTimer timerB;
+static ESPHWTimer timerC;
+
+static uint32_t _callsA = 0;
+static uint32_t _callsB = 0;
+static uint32_t _callsC = 0;
+static uint32_t _lastA = 0;
+
+static void countA(void* arg) {
+   (void)arg;
+   ++_callsA;
+   _lastA = stubNow();
+}
+
+static void countB(void* arg) {
+   (void)arg;
+   ++_callsB;
+}
+
+static void countC(void* arg) {
+   (void)arg;
+   ++_callsC;
+}
+
+// one-shot that re-arms itself from its callback
+static void rearmA(void* arg) {
+   (void)arg;
+   ++_callsA;
+   if (_callsA < 3) {
+      timerA.arm(false);
+   }
+}
+
+static void reset(void) {
+   timerA.disarm();
+   timerB.disarm();
+   timerC.disarm();
+   stubReset();
+   _callsA = _callsB = _callsC = 0;
+   _lastA = 0;
+}
+
+static void testRepeating(void) {
+   reset();
+   timerA.setIntervalMicros(100);
+   timerA.attachInterrupt(countA);
+   CHECK(timerA.arm(true));
+   stubAdvance(1050);
+   CHECK(_callsA == 10);
+   CHECK(timerA.armed());
+   CHECK(timerA.getFireCount() >= 10);
+}
+
+static void testOneShot(void) {
+   reset();
+   timerA.setIntervalMicros(250);
+   timerA.attachInterrupt(countA);
+   CHECK(timerA.arm(false));
+   CHECK(timerA.armed());
+   stubAdvance(249);
+   CHECK(_callsA == 0);
+   stubAdvance(1000);
+   CHECK(_callsA == 1);
+   CHECK(!timerA.armed());
+   CHECK(!stubFRC1Loaded());
+}
+
+// several timers share FRC1
+static void testMultiplexed(void) {
+   reset();
+   timerA.setIntervalMicros(100);
+   timerA.attachInterrupt(countA);
+   timerB.setIntervalMicros(300);
+   timerB.attachInterrupt(countB);
+   timerC.setIntervalMicros(1000);
+   timerC.attachInterrupt(countC);
+   timerA.arm(true);
+   timerB.arm(true);
+   timerC.arm(false);
+   stubAdvance(3010);
+   CHECK(_callsA == 30);
+   CHECK(_callsB == 10);
+   CHECK(_callsC == 1);
+}
+
+// intervals longer than the 23-bit FRC1 counter are covered in several reloads
+static void testLongInterval(void) {
+   reset();
+   timerA.setInterval(4000);
+   timerA.attachInterrupt(countA);
+   timerA.arm(false);
+   stubAdvance(3999000);
+   CHECK(_callsA == 0);
+   stubAdvance(2000);
+   CHECK(_callsA == 1);
+   CHECK(stubStats.frc1Writes >= 3);
+}
+
+// arm() from the callback must not re-enable interrupts inside the ISR
+static void testArmFromCallback(void) {
+   reset();
+   timerA.setIntervalMicros(200);
+   timerA.attachInterrupt(rearmA);
+   timerA.arm(false);
+   stubAdvance(2000);
+   CHECK(_callsA == 3);
+   CHECK(!timerA.armed());
+   CHECK(stubStats.interruptsInISR == 0);
+}
+
+/*
+an FRC1 interrupt that arrives while arm() is running must not fire the timer on the deadline of its previous arm:
+the one-shot would be called at once and then left disarmed
+*/
+static void testArmRace(void) {
+   reset();
+   timerA.setIntervalMicros(100);
+   timerA.attachInterrupt(countA);
+   timerA.arm(false);
+   stubAdvance(200);
+   CHECK(_callsA == 1);
+   stubRaiseFRC1();
+   CHECK(timerA.arm(false));
+   CHECK(_callsA == 1);
+   CHECK(timerA.armed());
+   stubAdvance(99);
+   CHECK(_callsA == 1);
+   stubAdvance(2);
+   CHECK(_callsA == 2);
+}
+
+// retuning from the callback keeps the timer on its schedule
+static void retuneA(void* arg) {
+   (void)arg;
+   ++_callsA;
+   if (_callsA == 1) {
+      timerA.retuneMicros(500);
+   }
+   _lastA = stubNow();
+}
+
+static void testRetune(void) {
+   reset();
+   timerA.setIntervalMicros(100);
+   timerA.attachInterrupt(retuneA);
+   timerA.arm(true);
+   stubAdvance(100);
+   CHECK(_callsA == 1);
+   stubAdvance(499);
+   CHECK(_callsA == 1);
+   stubAdvance(1);
+   CHECK(_callsA == 2);
+   CHECK(_lastA == stubNow());
+   CHECK(timerA.getIntervalMicros() == 500);
+}
+
+/*
+a callback that re-enables interrupts and arms another timer must not leave FRC1 reloading with the minimum interval
+for its own deadline, which passes while it runs, until it returns. Its next callback then follows at once, as it
+has fallen behind
+*/
+static void slowA(void* arg) {
+   (void)arg;
+   if (++_callsA == 1) {
+      uint32_t savedPS = xt_rsil(0);
+      timerB.arm(false);
+      stubAdvance(500);
+      xt_wsr_ps(savedPS);
+   }
+}
+
+static void testSlowCallback(void) {
+   reset();
+   timerA.setIntervalMicros(100);
+   timerA.attachInterrupt(slowA);
+   timerB.setIntervalMicros(100);
+   timerB.attachInterrupt(countB);
+   timerA.arm(true);
+   stubAdvance(100);
+   CHECK(_callsB == 1);
+   CHECK(stubStats.frc1Interrupts <= 3);
+   CHECK(_callsA == 2);
+   stubAdvance(100);
+   CHECK(_callsA == 3);
+   timerA.disarm();
+}
+
+int main(void) {
+   testRepeating();
+   testOneShot();
+   testMultiplexed();
+   testLongInterval();
+   testArmFromCallback();
+   testArmRace();
+   testRetune();
+   testSlowCallback();
+   reset();
+   if (_failures == 0) {
+      printf("test_esp_hw: all tests passed\n");
+   }
+   return (_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Host test of the ESP8266 os_timer multiplexer (ESPTimer with USING_ESP_TIMER_MUX) against the stubbed core in stub/
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysTimer.h>
+#include <stdio.h>
+#include <string.h>
+#include <new>
+
+static int _failures = 0;
+
+#define CHECK(cond) \
+   do { \
+      if (!(cond)) { \
+         printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+         ++_failures; \
+      } \
+   } while (0)
+
+static ESPTimer timerA;
+static ESPTimer timerB;
+
+static uint32_t _callsA = 0;
+static uint32_t _callsB = 0;
+
+static void countA(void* arg) {
+   (void)arg;
+   ++_callsA;
+}
+
+static void countB(void* arg) {
+   (void)arg;
+   ++_callsB;
+}
+
+static void reset(void) {
+   timerA.disarm();
+   timerB.disarm();
+   stubAdvance(1000000);                             // let the multiplexer drop them
+   stubReset();
+   _callsA = _callsB = 0;
+}
+
+/*
+a timer destroyed while it is in the heap, armed or disarmed, must be taken out of it: its memory is overwritten
+here, so a pointer left behind would be called through
+*/
+static void testDestroy(void) {
+   alignas(ESPTimer) static uint8_t buffer[2][sizeof(ESPTimer)];
+
+   reset();
+   timerA.setInterval(50);
+   timerA.attachInterrupt(countA);
+   timerA.arm(true);
+   for (uint8_t i = 0; i < 2; i++) {
+      ESPTimer* doomed = new (buffer[i]) ESPTimer;
+      doomed->setInterval(10);
+      doomed->attachInterrupt(countB);
+      doomed->arm(true);
+      if (i == 1) {
+         doomed->disarm();                          // left in the heap until its deadline comes round
+      }
+      doomed->~ESPTimer();
+      memset(buffer[i], 0xA5, sizeof(buffer[i]));
+   }
+   stubAdvance(100000);
+   CHECK(_callsA == 2);
+   CHECK(_callsB == 0);
+}
+
+/*
+a disarm() from an interrupt that arrives as the handler takes a due timer off the heap must stop that timer: the
+FRC1 interrupt raised by the first callback stands in for it, and is taken when the handler next disables interrupts
+*/
+static void disarmB(void) {
+   timerB.disarm();
+}
+
+static void raiseA(void* arg) {
+   (void)arg;
+   ++_callsA;
+   stubRaiseFRC1();
+}
+
+static void testDisarmFromInterrupt(void) {
+   reset();
+   timer1_attachInterrupt(disarmB);
+   timerA.setInterval(10);
+   timerA.attachInterrupt(raiseA);
+   timerB.setInterval(10);
+   timerB.attachInterrupt(countB);
+   timerA.arm(false);
+   timerB.arm(false);
+   stubAdvance(10000);
+   CHECK(_callsA == 1);
+   CHECK(_callsB == 0);
+   CHECK(!timerB.armed());
+   timer1_attachInterrupt(nullptr);
+}
+
+int main(void) {
+   testDestroy();
+   testDisarmFromInterrupt();
+   reset();
+   if (_failures == 0) {
+      printf("test_esp_mux: all tests passed\n");
+   }
+   return (_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Host test of SysStepper against the stubbed core in stub/: the step pulses are rebuilt from the GPIO edge log
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysStepper.h>
+#include <stdio.h>
+
+static int _failures = 0;
+
+#define CHECK(cond) \
+   do { \
+      if (!(cond)) { \
+         printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+         ++_failures; \
+      } \
+   } while (0)
+
+#define STEP_PIN    4
+#define DIR_PIN     5
+
+static SysTimer   stepTimer;
+static SysStepper axis(stepTimer, STEP_PIN, DIR_PIN);
+
+// count the step pulses in the edge log, and the shortest
+static uint16_t pulses(uint32_t& shortest) {
+   uint16_t count = 0;
+   uint32_t rise = 0;
+   bool     high = false;
+
+   shortest = 0xFFFFFFFFUL;
+   for (uint16_t i = 0; i < stubEdgeCount; i++) {
+      bool level = (stubEdges[i].pins & (1UL << STEP_PIN)) != 0;
+      if (level && !high) {
+         rise = stubEdges[i].time;
+      } else if (!level && high) {
+         uint32_t width = stubEdges[i].time - rise;
+         shortest = (width < shortest) ? width : shortest;
+         ++count;
+      }
+      high = level;
+   }
+   return count;
+}
+
+// run() keeps the ring filled: every step is a full-width pulse, including the last
+static void testMove(void) {
+   uint32_t shortest;
+
+   stubReset();
+   axis.setMaxSpeed(2000);
+   axis.setAcceleration(20000);
+   CHECK(axis.move(100));
+   while (axis.run()) {
+      stubAdvance(100);
+   }
+   CHECK(axis.getPosition() == 100);
+   CHECK(axis.getUnderruns() == 0);
+   CHECK(pulses(shortest) == 100);
+   CHECK(shortest >= SYST_STEP_PULSE);
+}
+
+// run() is never called, so the ring runs dry part way through: the underrun steps still get full-width pulses
+static void testUnderrun(void) {
+   uint32_t shortest;
+
+   stubReset();
+   CHECK(axis.move(-200));
+   stubAdvance(2000000);
+   CHECK(!axis.moving());
+   CHECK(axis.getPosition() == -100);
+   CHECK(axis.getUnderruns() > 0);
+   CHECK(pulses(shortest) == 200);
+   CHECK(shortest >= SYST_STEP_PULSE);
+   axis.run();
+}
+
+int main(void) {
+   CHECK(axis.begin());
+   testMove();
+   testUnderrun();
+   if (_failures == 0) {
+      printf("test_stepper: all tests passed\n");
+   }
+   return (_failures == 0) ? 0 : 1;
+}
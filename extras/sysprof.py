@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+sysprof.py: map a SysProfiler histogram (the output of SysProfiler::dump) to the functions in the sketch's ELF file
+
+usage: sysprof.py [--nm NM] [--top N] sketch.elf dump.txt
+       sysprof.py dump.txt                          (P_TAG mode: no ELF file is needed)
+
+NM is the nm for the board's toolchain (avr-nm, arm-none-eabi-nm or xtensa-lx106-elf-nm), and the ELF file is left in
+the build directory by the Arduino IDE (turn on verbose output for compilation to see where). The dump may be a capture
+of the serial monitor: anything before the "# SysProfiler" line is skipped
+
+each bucket is counted against the function that contains its first address, so when the buckets are larger than your
+functions (see the shift in the dump), profile a smaller address range or use a larger histogram
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+"""
+
+import argparse
+import bisect
+import subprocess
+import sys
+
+
+def read_dump(path):
+    """return (mode, start, shift, samples, outside, {index: count}) from a SysProfiler dump"""
+    header = None
+    buckets = {}
+    with open(path) as dump:
+        for line in dump:
+            fields = line.split()
+            if fields[:2] == ["#", "SysProfiler"]:
+                header = fields[2:]
+                buckets = {}                                   # a later dump replaces an earlier one
+            elif (header is not None) and (len(fields) == 2) and fields[0].isdigit() and fields[1].isdigit():
+                buckets[int(fields[0])] = int(fields[1])
+    if header is None:
+        sys.exit("%s: no SysProfiler dump found" % path)
+    return header[0], int(header[1], 16), int(header[2]), int(header[3]), int(header[4]), buckets
+
+
+def read_symbols(nm, elf):
+    """return the code symbols in the ELF file as sorted lists of start addresses and (end, name)"""
+    try:
+        output = subprocess.check_output([nm, "--defined-only", "--numeric-sort", "--print-size", "--demangle", elf],
+                                         universal_newlines=True)
+    except (OSError, subprocess.CalledProcessError) as error:
+        sys.exit("%s: %s" % (nm, error))
+    starts = []
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if (len(fields) == 4) and (fields[2] in "tTwW"):
+            start = int(fields[0], 16) & ~1                   # Thumb functions have the low bit set
+            starts.append(start)
+            symbols.append((start + int(fields[1], 16), fields[3]))
+    return starts, symbols
+
+
+def lookup(starts, symbols, address):
+    i = bisect.bisect_right(starts, address) - 1
+    if (i >= 0) and (address < symbols[i][0]):
+        return symbols[i][1]
+    return "0x%x" % address
+
+
+def main():
+    parser = argparse.ArgumentParser(description="map a SysProfiler histogram to functions")
+    parser.add_argument("--nm", default="nm", help="nm for the board's toolchain, e.g. avr-nm")
+    parser.add_argument("--top", type=int, default=30, help="number of lines to print")
+    parser.add_argument("files", nargs="+", metavar="FILE", help="[sketch.elf] dump.txt")
+    args = parser.parse_args()
+
+    mode, start, shift, samples, outside, buckets = read_dump(args.files[-1])
+    totals = {}
+    if mode == "tag":
+        for index, count in buckets.items():
+            totals["tag %d" % index] = count
+    else:
+        if len(args.files) < 2:
+            sys.exit("the ELF file is needed to map addresses to functions")
+        starts, symbols = read_symbols(args.nm, args.files[0])
+        for index, count in buckets.items():
+            name = lookup(starts, symbols, start + (index << shift))
+            totals[name] = totals.get(name, 0) + count
+    if outside > 0:
+        totals["(outside)"] = outside
+
+    print("%d samples, %d bytes per bucket" % (samples, 1 << shift) if mode != "tag" else "%d samples" % samples)
+    for name, count in sorted(totals.items(), key=lambda item: item[1], reverse=True)[:args.top]:
+        print("%6.2f%% %8d  %s" % ((100.0 * count / samples) if samples else 0.0, count, name))
+
+
+if __name__ == "__main__":
+    main()
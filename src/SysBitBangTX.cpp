@@ -0,0 +1,159 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysBitBangTX.h>
+
+/*
+timer callback: send the next bit, loading the next queued byte at the end of each frame
+
+UART frames are 10 ticks: a start bit (0), 8 data bits LSB first, and a stop bit (1) which is left on the line
+SPI frames are 16 ticks: the data bit is set with the clock low, then the clock is raised for the receiver to sample it
+
+checking for an empty queue and clearing _busy cannot be interrupted by write(), so write() either sees _busy still
+set after its byte is queued (and we send it), or sees it clear and re-arms the timer
+*/
+void SYST_ISR_ATTR _SysBitBangTXHandler(void* arg) {
+   SysBitBangTX* that = static_cast<SysBitBangTX*>(arg);
+
+   if (that->_ticks == 0) {
+      if (that->_tail == that->_head) {
+         if (that->_mode == BitBangMode::B_SPI) {
+            sysPortClear(that->_clockReg, that->_clockMask);
+         }
+         that->_busy = false;
+         that->_timer.disarm();
+         return;
+      }
+      uint8_t value = that->_queue[that->_tail];
+      that->_tail = (that->_tail + 1) & (SYST_TX_QUEUE - 1);
+      if (that->_mode == BitBangMode::B_UART) {
+         that->_frame = (static_cast<uint16_t>(value) << 1) | 0x200;
+         that->_ticks = 10;
+      } else {
+         that->_frame = value;
+         that->_ticks = 16;
+      }
+   }
+
+   if (that->_mode == BitBangMode::B_UART) {
+      if (that->_frame & 0x01) {
+         sysPortSet(that->_dataReg, that->_dataMask);
+      } else {
+         sysPortClear(that->_dataReg, that->_dataMask);
+      }
+      that->_frame >>= 1;
+   } else if (that->_ticks & 0x01) {
+      sysPortSet(that->_clockReg, that->_clockMask);
+   } else {
+      sysPortClear(that->_clockReg, that->_clockMask);
+      if (that->_frame & 0x80) {
+         sysPortSet(that->_dataReg, that->_dataMask);
+      } else {
+         sysPortClear(that->_dataReg, that->_dataMask);
+      }
+      that->_frame <<= 1;
+   }
+   --that->_ticks;
+}
+
+/*
+returns false if the timer could not be allocated, or cannot tick to the usec (see SysTimerBase::canRetune): the AVR
+8-bit timers and the ESP8266 os_timer only have msec resolution, so the line would be clocked at the wrong rate
+*/
+bool SysBitBangTX::begin(const uint32_t tickMicros) {
+   if (!_timer.begin() || !_timer.canRetune() || (tickMicros == 0)) {
+      _dataMask = 0;                                   // so write() refuses bytes
+      return false;
+   }
+   _head = 0;
+   _tail = 0;
+   _ticks = 0;
+   _busy = false;
+   _timer.attachInterrupt(_SysBitBangTXHandler, this);
+   _timer.setIntervalMicros(tickMicros);
+   return true;
+}
+
+/*
+software UART transmitter: the line idles high
+
+the bit time is rounded to whole usec, so the baud rate error grows with the baud rate: keep it within the
+2-3% a UART receiver tolerates, and low enough for the timer callback to keep up (about 19200 baud on the AVR)
+*/
+bool SysBitBangTX::beginUART(const uint8_t txPin, const uint32_t baud) {
+   if ((baud == 0) || !sysPortLookup(txPin, _dataReg, _dataMask)) {
+      return false;
+   }
+   _mode = BitBangMode::B_UART;
+   pinMode(txPin, OUTPUT);
+   digitalWrite(txPin, HIGH);
+   return begin((1000000UL + (baud / 2)) / baud);
+}
+
+// software SPI transmitter: the timer ticks at twice the bit rate, once for each clock edge
+bool SysBitBangTX::beginSPI(const uint8_t dataPin, const uint8_t clockPin, const uint32_t bitRate) {
+   if ((bitRate == 0) || !sysPortLookup(dataPin, _dataReg, _dataMask) || !sysPortLookup(clockPin, _clockReg, _clockMask)) {
+      return false;
+   }
+   _mode = BitBangMode::B_SPI;
+   pinMode(dataPin, OUTPUT);
+   digitalWrite(dataPin, LOW);
+   pinMode(clockPin, OUTPUT);
+   digitalWrite(clockPin, LOW);
+   return begin((1000000UL + bitRate) / (2 * bitRate));
+}
+
+/*
+queue a byte, starting the timer if it is idle
+
+returns false if the queue is full
+*/
+bool SysBitBangTX::write(const uint8_t value) {
+   uint8_t next = (_head + 1) & (SYST_TX_QUEUE - 1);
+
+   if ((_dataMask == 0) || (next == _tail)) {
+      return false;
+   }
+   _queue[_head] = value;
+   _head = next;
+   if (!_busy) {
+      _busy = true;
+      _timer.arm(true);
+   }
+   return true;
+}
+
+// queue as many bytes as there is room for, and return the number queued
+uint16_t SysBitBangTX::write(const uint8_t* data, const uint16_t count) {
+   uint16_t queued = 0;
+
+   while ((queued < count) && write(data[queued])) {
+      ++queued;
+   }
+   return queued;
+}
+
+// stop sending and discard any queued bytes
+void SysBitBangTX::end(void) {
+   _timer.disarm();
+   _busy = false;
+   _ticks = 0;
+   _tail = _head;
+}
@@ -0,0 +1,77 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysBitBangTX_H_
+#define _SysBitBangTX_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+#define SYST_TX_QUEUE    64                       // bytes queued for transmission, must be a power of 2
+
+enum class BitBangMode:uint8_t { B_UART, B_SPI };
+
+/*
+transmit-only software UART (8N1) or SPI (mode 0, MSB first) clocked by one SysTimer
+
+write() only queues the bytes; the timer callback shifts out one bit per tick (one clock edge per tick for SPI),
+so loop() never waits on the line. The timer is armed by write() and disarms itself when the queue is empty
+*/
+class SysBitBangTX {
+public:
+   explicit SysBitBangTX(SysTimer& timer) : _timer(timer) {}
+
+   bool     beginUART(const uint8_t txPin, const uint32_t baud);
+   bool     beginSPI(const uint8_t dataPin, const uint8_t clockPin, const uint32_t bitRate);
+   bool     write(const uint8_t value);
+   uint16_t write(const uint8_t* data, const uint16_t count);
+   void     end(void);
+
+   // true while there are bytes queued or being sent
+   bool busy(void) const {
+      return _busy;
+   }
+
+   uint16_t availableForWrite(void) const {
+      return (SYST_TX_QUEUE - 1) - ((_head - _tail) & (SYST_TX_QUEUE - 1));
+   }
+
+private:
+   bool begin(const uint32_t tickMicros);
+
+   SysTimer&          _timer;
+   BitBangMode        _mode = BitBangMode::B_UART;
+   SysPortReg         _dataReg;
+   SysPortMask        _dataMask = 0;
+   SysPortReg         _clockReg;
+   SysPortMask        _clockMask = 0;
+
+   uint8_t            _queue[SYST_TX_QUEUE];
+   volatile uint8_t   _head = 0;                        // written by write()
+   volatile uint8_t   _tail = 0;                        // written by the callback
+   volatile bool      _busy = false;
+
+   uint16_t           _frame = 0;                       // bits still to send, next bit in bit 0 (UART) or bit 7 (SPI)
+   uint8_t            _ticks = 0;                       // ticks left in the frame
+
+   friend void _SysBitBangTXHandler(void* arg);
+};
+
+#endif //header protect
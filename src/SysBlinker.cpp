@@ -0,0 +1,161 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysBlinker.h>
+
+// mask for a pin's bit number: the AVR has no barrel shifter, so a table is quicker than a variable shift
+#if defined(__AVR__)
+static const uint8_t _bitMask[8] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+#define BIT_MASK(bit)      _bitMask[(bit) & 0x07]
+#else
+#define BIT_MASK(bit)      (static_cast<SysPortMask>(1UL << (bit)))
+#endif
+
+/*
+timer callback: collect the new state of every LED whose pattern steps on this tick, then write each port once
+LEDs that do not step on this tick are left out of both masks, so their pins are not touched
+*/
+void SYST_ISR_ATTR _SysBlinkerHandler(void* arg) {
+   SysBlinker* that = static_cast<SysBlinker*>(arg);
+   SysPortMask on[SYST_BLINK_PORTS] = { 0 };
+   SysPortMask off[SYST_BLINK_PORTS] = { 0 };
+   uint32_t    tick = that->_tick++;
+   uint8_t     zeros = (tick == 0) ? 32 : static_cast<uint8_t>(__builtin_ctzl(tick));     // LEDs with shift <= zeros step
+
+   for (uint16_t i = 0; i < that->_count; i++) {
+      SysBlinkLED& led = that->_leds[i];
+
+      if (led.shift > zeros) {
+         continue;
+      }
+      uint32_t    pattern = led.pattern;
+      uint8_t     port = led.portBit >> 5;
+      SysPortMask mask = BIT_MASK(led.portBit & 0x1F);
+      if (pattern & 0x01) {
+         on[port] |= mask;
+      } else {
+         off[port] |= mask;
+      }
+      led.pattern = (pattern >> 1) | (pattern << 31);
+   }
+   for (uint8_t p = 0; p < that->_ports; p++) {
+      if (on[p]) {
+         sysPortSet(that->_portReg[p], on[p]);
+      }
+      if (off[p]) {
+         sysPortClear(that->_portReg[p], off[p]);
+      }
+   }
+}
+
+/*
+rotate a pattern between its stored form and the form it was given in: the stored pattern has been rotated right
+once for every step the LED has taken, so bit 0 is the state at its next step, which is step
+ceil(_tick / (1 << shift)) counting from tick 0
+
+must be called with interrupts disabled, since the callback advances _tick
+*/
+uint32_t SysBlinker::align(const uint32_t pattern, const uint8_t shift, const bool rotate) const {
+   uint8_t step = static_cast<uint8_t>(((_tick >> shift) + ((_tick & ((1UL << shift) - 1)) ? 1 : 0)) & 0x1F);
+
+   if (step == 0) {
+      return pattern;
+   }
+   return rotate ? ((pattern >> step) | (pattern << (32 - step))) : ((pattern << step) | (pattern >> (32 - step)));
+}
+
+/*
+add an LED with its pattern, which steps every (1 << shift) ticks
+
+returns the LED number, or -1 if the table is full or the pin is on a port we have no room for
+*/
+int16_t SysBlinker::attach(const uint8_t pin, const uint32_t pattern, const uint8_t shift) {
+   SysPortReg  reg;
+   SysPortMask mask;
+   uint8_t     p = 0;
+   uint8_t     bit = 0;
+
+   if ((_count >= _capacity) || !sysPortLookup(pin, reg, mask)) {
+      return -1;
+   }
+   while ((p < _ports) && (_portReg[p] != reg)) {
+      ++p;
+   }
+   if (p == SYST_BLINK_PORTS) {
+      return -1;
+   }
+   while (!(mask & 0x01)) {
+      mask >>= 1;
+      ++bit;
+   }
+   pinMode(pin, OUTPUT);
+   digitalWrite(pin, LOW);
+
+   SysBlinkLED& led = _leds[_count];
+   led.portBit = (p << 5) | bit;
+   led.shift = (shift < 31) ? shift : 31;
+
+   // publish the new port and LED only once they are complete
+   noInterrupts();
+   led.pattern = align(pattern, led.shift, true);
+   if (p == _ports) {
+      _portReg[p] = reg;
+      ++_ports;
+   }
+   ++_count;
+   interrupts();
+   return _count - 1;
+}
+
+// the new pattern takes effect from the LED's next step
+bool SysBlinker::setPattern(const int16_t led, const uint32_t pattern, const uint8_t shift) {
+   if ((led < 0) || (led >= _count)) {
+      return false;
+   }
+   SYST_LOCK();
+   _leds[led].shift = (shift < 31) ? shift : 31;
+   _leds[led].pattern = align(pattern, _leds[led].shift, true);
+   SYST_UNLOCK();
+   return true;
+}
+
+/*
+start stepping the patterns every tickMs msec: with the default of 25 msec, a pattern with a shift of 0 repeats
+every 0.8 sec
+*/
+bool SysBlinker::begin(const uint32_t tickMs) {
+   if (!_timer.begin() || (_leds == nullptr)) {
+      return false;
+   }
+   // the patterns restart from step 0
+   SYST_LOCK();
+   for (uint16_t i = 0; i < _count; i++) {
+      _leds[i].pattern = align(_leds[i].pattern, _leds[i].shift, false);
+   }
+   _tick = 0;
+   SYST_UNLOCK();
+   _timer.attachInterrupt(_SysBlinkerHandler, this);
+   _timer.setInterval(tickMs);
+   return _timer.arm(true);
+}
+
+void SysBlinker::end(void) {
+   _timer.disarm();
+}
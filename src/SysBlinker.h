@@ -0,0 +1,100 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysBlinker_H_
+#define _SysBlinker_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+#define SYST_BLINK_PORTS       8                   // maximum number of distinct ports the LEDs may be on
+
+// some 32-step patterns: bit n is the LED state at step n
+#define SYST_BLINK_OFF         0x00000000UL
+#define SYST_BLINK_ON          0xFFFFFFFFUL
+#define SYST_BLINK_SLOW        0x0000FFFFUL        // 50% duty, once per cycle
+#define SYST_BLINK_FAST        0x0F0F0F0FUL        // 50% duty, four times per cycle
+#define SYST_BLINK_FLASH       0x00000003UL        // short flash, once per cycle
+#define SYST_BLINK_DOUBLE      0x00000033UL        // two short flashes, once per cycle
+
+/*
+one LED: 6 bytes of RAM on the AVR (8 with padding on the 32-bit platforms)
+
+the port index and bit number are packed into one byte, and the speed is a shift rather than a counter. The pattern
+is kept rotated so that bit 0 is the LED state at its next step, and it is rotated by one bit each step, so the
+callback never has to shift by a variable count
+*/
+struct SysBlinkLED {
+   uint32_t pattern;                            // rotated right by the number of steps taken (see SysBlinker::align)
+   uint8_t  portBit;                            // port index << 5 | bit number
+   uint8_t  shift;                              // the pattern steps every (1 << shift) ticks
+};
+
+/*
+drives the blink patterns of any number of LEDs from one SysTimer
+
+each LED has a 32-step bit pattern. On each tick, every LED whose pattern steps is collected into per-port on and
+off masks, and each port is then written once, however many LEDs are on it. The LEDs all count from the same tick,
+so LEDs with the same speed blink in step
+
+an LED steps on the ticks that are a multiple of (1 << shift), i.e. when the tick has at least shift trailing zero
+bits, so the callback counts these once per tick and only has to compare one byte for each LED that does not step
+
+the sketch declares the SysBlinkLED array and passes its capacity, and attach() fills it in order
+*/
+class SysBlinker {
+public:
+   SysBlinker(SysTimer& timer, SysBlinkLED* leds, const uint16_t capacity) : _timer(timer), _leds(leds), _capacity(capacity) {}
+
+   int16_t  attach(const uint8_t pin, const uint32_t pattern = SYST_BLINK_OFF, const uint8_t shift = 0);
+   bool     setPattern(const int16_t led, const uint32_t pattern, const uint8_t shift = 0);
+   bool     begin(const uint32_t tickMs = 25);
+   void     end(void);
+
+   uint32_t getPattern(const int16_t led) const {
+      if ((led < 0) || (led >= _count)) {
+         return SYST_BLINK_OFF;
+      }
+      SYST_LOCK();
+      uint32_t pattern = align(_leds[led].pattern, _leds[led].shift, false);
+      SYST_UNLOCK();
+      return pattern;
+   }
+
+   uint16_t getCount(void) const {
+      return _count;
+   }
+
+private:
+   uint32_t align(const uint32_t pattern, const uint8_t shift, const bool rotate) const;
+
+   SysTimer&      _timer;
+   SysBlinkLED*   _leds;
+   uint16_t       _capacity;
+   uint16_t       _count = 0;
+   uint32_t       _tick = 0;
+
+   uint8_t        _ports = 0;
+   SysPortReg     _portReg[SYST_BLINK_PORTS];
+
+   friend void _SysBlinkerHandler(void* arg);
+};
+
+#endif //header protect
@@ -0,0 +1,158 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysDebouncer.h>
+
+/*
+compiler barrier around the queue indexes: _head and _tail are volatile but the queue is not, so without it the
+compiler may move an event's stores after the _head store that publishes it, or its loads after the _tail store
+that frees the entry. The queue is only shared with our own timer callback, so no hardware barrier is needed
+*/
+#define QUEUE_BARRIER()    asm volatile("" ::: "memory")
+
+/*
+timer callback: sample each port and step its vertical counter
+
+a bit's counter is reset whenever the input matches the debounced level, and otherwise counts 1, 2, 3, 0: when
+it wraps back to 0 the input has differed for 4 samples in a row, and the debounced level toggles
+
+only the producer index is written here, so the queue needs no lock: if it is full the event is dropped and counted,
+but the debounced levels are still updated
+*/
+void SYST_ISR_ATTR _SysDebouncerHandler(void* arg) {
+   SysDebouncer* that = static_cast<SysDebouncer*>(arg);
+
+   for (uint8_t p = 0; p < that->_ports; p++) {
+      SysPortMask state = that->_state[p];
+      SysPortMask delta = (sysPortRead(that->_portReg[p]) ^ state) & that->_portPins[p];
+
+      that->_count1[p] = (that->_count1[p] ^ that->_count0[p]) & delta;
+      that->_count0[p] = ~that->_count0[p] & delta;
+
+      SysPortMask toggle = delta & ~(that->_count0[p] | that->_count1[p]);
+      if (toggle) {
+         state ^= toggle;
+         that->_state[p] = state;
+
+         uint8_t next = (that->_head + 1) & (SYST_DEBOUNCE_QUEUE - 1);
+         if (next != that->_tail) {
+            SysDebounceEvent& event = that->_queue[that->_head];
+            event.port = p;
+            event.changed = toggle;
+            event.state = state;
+            QUEUE_BARRIER();
+            that->_head = next;
+         } else {
+            ++that->_overruns;
+         }
+      }
+   }
+}
+
+/*
+add a pin as an input, with the pullup enabled by default
+
+returns the input number, or -1 if there are no inputs left or the pin is on a port we have no room for
+*/
+int8_t SysDebouncer::attach(const uint8_t pin, const bool pullup) {
+   SysPortReg  reg;
+   SysPortMask mask;
+   uint8_t     p = 0;
+
+   if ((_inputs >= SYST_DEBOUNCE_INPUTS) || !sysPortInputLookup(pin, reg, mask)) {
+      return -1;
+   }
+   while ((p < _ports) && (_portReg[p] != reg)) {
+      ++p;
+   }
+   if (p == SYST_DEBOUNCE_PORTS) {
+      return -1;
+   }
+   pinMode(pin, pullup ? INPUT_PULLUP : INPUT);
+
+   // start from the current level, so attaching a pin does not generate an event
+   noInterrupts();
+   if (p == _ports) {
+      _portReg[p] = reg;
+      _portPins[p] = 0;
+      _count0[p] = 0;
+      _count1[p] = 0;
+      _state[p] = 0;
+      ++_ports;
+   }
+   _portPins[p] |= mask;
+   _state[p] = (_state[p] & ~mask) | (sysPortRead(reg) & mask);
+   interrupts();
+
+   _inputPin[_inputs] = pin;
+   _inputPort[_inputs] = p;
+   _inputMask[_inputs] = mask;
+   return _inputs++;
+}
+
+/*
+start sampling every sampleMs msec, so an input must be stable for SYST_DEBOUNCE_SAMPLES x sampleMs to be accepted
+*/
+bool SysDebouncer::begin(const uint32_t sampleMs) {
+   if (!_timer.begin()) {
+      return false;
+   }
+   _timer.attachInterrupt(_SysDebouncerHandler, this);
+   _timer.setInterval(sampleMs);
+   return _timer.arm(true);
+}
+
+void SysDebouncer::end(void) {
+   _timer.disarm();
+}
+
+/*
+get the next input that changed, and its new debounced level, oldest first
+
+returns false if there are no more changes
+*/
+bool SysDebouncer::read(int8_t& input, bool& level) {
+   while (true) {
+      while (_scan < _inputs) {
+         uint8_t i = _scan++;
+         if ((_inputPort[i] == _event.port) && (_inputMask[i] & _event.changed)) {
+            input = i;
+            level = (_event.state & _inputMask[i]) != 0;
+            return true;
+         }
+      }
+      if (_tail == _head) {
+         return false;
+      }
+      QUEUE_BARRIER();
+      _event = _queue[_tail];
+      QUEUE_BARRIER();
+      _tail = (_tail + 1) & (SYST_DEBOUNCE_QUEUE - 1);
+      _scan = 0;
+   }
+}
+
+// current debounced level of an input
+bool SysDebouncer::level(const int8_t input) const {
+   if ((input < 0) || (input >= _inputs)) {
+      return false;
+   }
+   return (_state[_inputPort[input]] & _inputMask[input]) != 0;
+}
@@ -0,0 +1,101 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysDebouncer_H_
+#define _SysDebouncer_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+#define SYST_DEBOUNCE_INPUTS   64               // maximum number of input pins per debouncer
+#define SYST_DEBOUNCE_PORTS    8                // maximum number of distinct ports those pins may be on
+#define SYST_DEBOUNCE_QUEUE    16               // port change events buffered for read(), must be a power of 2
+#define SYST_DEBOUNCE_SAMPLES  4                // consecutive samples an input must hold a new level for
+
+// the inputs on one port that changed on a tick, and the debounced levels of the whole port after the change
+struct SysDebounceEvent {
+   uint8_t     port;
+   SysPortMask changed;
+   SysPortMask state;
+};
+
+/*
+debounces up to SYST_DEBOUNCE_INPUTS pins by sampling whole ports on each timer tick
+
+each port has a 2-bit vertical counter: bit n of _count0 and _count1 is the counter for bit n of the port, so all
+the pins on a port are integrated with a few logical operations, however many there are. A pin's debounced level
+changes once its input has differed from it for SYST_DEBOUNCE_SAMPLES ticks in a row
+
+the callback queues one event per port per tick with changes, and read() expands these into one event per pin in loop()
+*/
+class SysDebouncer {
+public:
+   explicit SysDebouncer(SysTimer& timer) : _timer(timer) {}
+
+   int8_t   attach(const uint8_t pin, const bool pullup = true);
+   bool     begin(const uint32_t sampleMs = 5);
+   void     end(void);
+   bool     read(int8_t& input, bool& level);
+   bool     level(const int8_t input) const;
+
+   uint16_t getOverruns(void) const {
+      SYST_LOCK();
+      uint16_t overruns = _overruns;
+      SYST_UNLOCK();
+      return overruns;
+   }
+
+   uint8_t getInputs(void) const {
+      return _inputs;
+   }
+
+   uint8_t getPin(const int8_t input) const {
+      return ((input >= 0) && (input < _inputs)) ? _inputPin[input] : 0xFF;
+   }
+
+private:
+   SysTimer&                  _timer;
+
+   uint8_t                    _ports = 0;
+   SysPortReg                 _portReg[SYST_DEBOUNCE_PORTS];
+   SysPortMask                _portPins[SYST_DEBOUNCE_PORTS];         // debounced pins on each port
+   SysPortMask                _count0[SYST_DEBOUNCE_PORTS];           // vertical counter, low bits
+   SysPortMask                _count1[SYST_DEBOUNCE_PORTS];           // vertical counter, high bits
+   volatile SysPortMask       _state[SYST_DEBOUNCE_PORTS];            // debounced levels
+
+   uint8_t                    _inputs = 0;
+   uint8_t                    _inputPin[SYST_DEBOUNCE_INPUTS];
+   uint8_t                    _inputPort[SYST_DEBOUNCE_INPUTS];
+   SysPortMask                _inputMask[SYST_DEBOUNCE_INPUTS];
+
+   // single producer (the callback), single consumer (read) queue
+   SysDebounceEvent           _queue[SYST_DEBOUNCE_QUEUE];
+   volatile uint8_t           _head = 0;                              // written by the callback
+   volatile uint8_t           _tail = 0;                              // written by read()
+   volatile uint16_t          _overruns = 0;
+
+   // the event read() is expanding
+   SysDebounceEvent           _event;
+   uint8_t                    _scan = SYST_DEBOUNCE_INPUTS;
+
+   friend void _SysDebouncerHandler(void* arg);
+};
+
+#endif //header protect
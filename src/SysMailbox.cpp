@@ -0,0 +1,124 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysMailbox.h>
+
+#define MAILBOX_MASK      (SYST_MAILBOX_SIZE - 1)
+
+#if defined(__SAM3X8E__)
+static inline bool claimSlot(volatile uint8_t* head, volatile uint8_t* tail, uint8_t& slot) {
+   uint8_t value;
+
+   do {
+      value = __LDREXB(head);
+      if (static_cast<uint8_t>(value - *tail) >= SYST_MAILBOX_SIZE) {
+         __CLREX();
+         return false;
+      }
+   } while (__STREXB(value + 1, head));
+   slot = value & MAILBOX_MASK;
+   return true;
+}
+
+static inline void countOverrun(volatile uint8_t* overruns) {
+   uint8_t value;
+
+   do {
+      value = __LDREXB(overruns);
+   } while (__STREXB((value < 0xFF) ? (value + 1) : value, overruns));
+}
+
+#define PUBLISH()          __DMB()                       // the event must be written before the slot is marked ready
+
+#else
+static inline bool SYST_ISR_ATTR claimSlot(volatile uint8_t* head, volatile uint8_t* tail, uint8_t& slot) {
+   bool claimed = false;
+
+   SYST_LOCK();
+   if (static_cast<uint8_t>(*head - *tail) < SYST_MAILBOX_SIZE) {
+      slot = *head & MAILBOX_MASK;
+      *head = *head + 1;
+      claimed = true;
+   }
+   SYST_UNLOCK();
+   return claimed;
+}
+
+static inline void SYST_ISR_ATTR countOverrun(volatile uint8_t* overruns) {
+   SYST_LOCK();
+   if (*overruns < 0xFF) {
+      *overruns = *overruns + 1;
+   }
+   SYST_UNLOCK();
+}
+
+#define PUBLISH()
+#endif
+
+/*
+post an event: this may be called from any interrupt handler, or from loop()
+
+returns false, and counts an overrun, if the mailbox is full
+*/
+bool SYST_ISR_ATTR SysMailbox::post(const uint8_t type, const uint32_t value) {
+   uint8_t slot;
+
+   if (!claimSlot(&_head, &_tail, slot)) {
+      countOverrun(&_overruns);
+      return false;
+   }
+   _type[slot] = type;
+   _value[slot] = value;
+   PUBLISH();
+   _ready[slot] = true;
+   return true;
+}
+
+/*
+take the oldest event: call this from loop() (there must only be one receiver)
+
+returns false if there are no events ready
+*/
+bool SysMailbox::receive(SysEvent& event) {
+   uint8_t slot = _tail & MAILBOX_MASK;
+
+   if (!_ready[slot]) {
+      return false;
+   }
+   event.type = _type[slot];
+   event.value = _value[slot];
+   _ready[slot] = false;
+   _tail = _tail + 1;                                       // frees the slot
+   return true;
+}
+
+/*
+take up to count events, oldest first
+
+returns the number of events taken
+*/
+uint8_t SysMailbox::receive(SysEvent* events, const uint8_t count) {
+   uint8_t taken = 0;
+
+   while ((taken < count) && receive(events[taken])) {
+      ++taken;
+   }
+   return taken;
+}
@@ -0,0 +1,73 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysMailbox_H_
+#define _SysMailbox_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+#define SYST_MAILBOX_SIZE      16                // events, must be a power of 2 no larger than 128
+
+// an event: what happened, and a value to go with it (a count, a timestamp, a pin etc.)
+struct SysEvent {
+   uint8_t  type;
+   uint32_t value;
+};
+
+/*
+a bounded mailbox that any number of interrupt handlers (and loop()) can post events to, and loop() takes them from
+
+each sender claims a slot by advancing the head, writes its event, then marks the slot ready; the receiver takes
+events in order as long as the next slot is ready. So an event is never lost or torn when two handlers post at
+almost the same time, even if one interrupts the other between claiming and filling its slot: the events behind
+the unfinished one just wait until it is ready
+
+SAM: slots are claimed with LDREXB/STREXB, so no interrupt is ever disabled, and nested (prioritised) interrupt
+handlers may post
+AVR and ESP8266: there are no exclusive loads and stores, so the claim is made in a few instructions with interrupts
+disabled, restoring the previous state (SREG or the interrupt level) afterwards
+*/
+class SysMailbox {
+public:
+   bool     post(const uint8_t type, const uint32_t value = 0);
+   bool     receive(SysEvent& event);
+   uint8_t  receive(SysEvent* events, const uint8_t count);
+
+   // events waiting (including any still being posted)
+   uint8_t available(void) const {
+      return static_cast<uint8_t>(_head - _tail);
+   }
+
+   // events dropped because the mailbox was full
+   uint8_t getOverruns(void) const {
+      return _overruns;
+   }
+
+private:
+   volatile uint8_t     _type[SYST_MAILBOX_SIZE];
+   volatile uint32_t    _value[SYST_MAILBOX_SIZE];
+   volatile bool        _ready[SYST_MAILBOX_SIZE] = { false };       // the event in this slot has been written
+   volatile uint8_t     _head = 0;                                    // next slot to claim: free running
+   volatile uint8_t     _tail = 0;
+   volatile uint8_t     _overruns = 0;
+};
+
+#endif //header protect
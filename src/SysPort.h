@@ -0,0 +1,199 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+/*
+Direct port access for the timer-driven engines (SysSoftPWM etc.)
+
+Pins are resolved once to a port and a bit mask, so the interrupt handlers can change every pin on the same port
+with a single register write rather than a digitalWrite() per pin
+
+sysInterruptedPC() returns the address that a timer interrupt interrupted, for use in a timer callback (SysWatchdog,
+SysProfiler). It is a byte address, as used in the map file and by addr2line, or 0 if it cannot be found
+*/
+
+#ifndef _SysPort_H_
+#define _SysPort_H_
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#error Older versions of Arduino IDE not supported
+#endif
+
+#include <SysTimer.h>
+
+#if defined(ESP8266)
+
+// timer callbacks run from the FRC1 interrupt (USING_ESP_HW_TIMER), so the engines' handlers must be in IRAM
+#define SYST_ISR_ATTR ICACHE_RAM_ATTR
+
+// GPIO 0-15 are all on the one port; GPIO 16 is in the RTC block and is not supported
+typedef uint8_t  SysPortReg;
+typedef uint32_t SysPortMask;
+
+inline bool sysPortLookup(const uint8_t pin, SysPortReg& reg, SysPortMask& mask) {
+   if (pin > 15) {
+      return false;
+   }
+   reg = 0;
+   mask = 1UL << pin;
+   return true;
+}
+
+// the set and clear registers only change the bits written, so no read-modify-write is needed
+inline void sysPortSet(const SysPortReg reg, const SysPortMask mask) {
+   (void)reg;
+   GPOS = mask;
+}
+
+inline void sysPortClear(const SysPortReg reg, const SysPortMask mask) {
+   (void)reg;
+   GPOC = mask;
+}
+
+inline bool sysPortInputLookup(const uint8_t pin, SysPortReg& reg, SysPortMask& mask) {
+   return sysPortLookup(pin, reg, mask);
+}
+
+inline SysPortMask sysPortRead(const SysPortReg reg) {
+   (void)reg;
+   return GPI;
+}
+
+// the FRC1 interrupt is a level 1 interrupt (USING_ESP_HW_TIMER), so the interrupted address is in EPC1
+inline uint32_t sysInterruptedPC(void) {
+   uint32_t pc;
+
+   asm volatile("rsr %0, epc1" : "=r"(pc));
+   return pc;
+}
+
+#elif defined(__SAM3X8E__)
+
+#define SYST_ISR_ATTR
+
+typedef Pio*     SysPortReg;
+typedef uint32_t SysPortMask;
+
+inline bool sysPortLookup(const uint8_t pin, SysPortReg& reg, SysPortMask& mask) {
+   if (pin >= PINS_COUNT) {
+      return false;
+   }
+   reg = digitalPinToPort(pin);
+   mask = digitalPinToBitMask(pin);
+   return true;
+}
+
+// the set and clear registers only change the bits written, so no read-modify-write is needed
+inline void sysPortSet(const SysPortReg reg, const SysPortMask mask) {
+   reg->PIO_SODR = mask;
+}
+
+inline void sysPortClear(const SysPortReg reg, const SysPortMask mask) {
+   reg->PIO_CODR = mask;
+}
+
+// the pin data status register is only updated while the port's peripheral clock is enabled, which pinMode() does
+inline bool sysPortInputLookup(const uint8_t pin, SysPortReg& reg, SysPortMask& mask) {
+   return sysPortLookup(pin, reg, mask);
+}
+
+inline SysPortMask sysPortRead(const SysPortReg reg) {
+   return reg->PIO_PDSR;
+}
+
+#define SYST_STACK_SCAN        64                  // stack words searched for the exception frame
+
+/*
+the interrupt handler pushes its EXC_RETURN value (0xFFFFFFF9 returning to thread mode, 0xFFFFFFF1 returning to
+another handler) immediately below the exception frame that the processor stacked, and the return address is the
+7th word of that frame
+*/
+inline uint32_t sysInterruptedPC(void) {
+   uint32_t* sp = reinterpret_cast<uint32_t*>(__get_MSP());
+
+   for (uint8_t i = 0; i < SYST_STACK_SCAN; i++) {
+      if ((sp[i] == 0xFFFFFFF9UL) || (sp[i] == 0xFFFFFFF1UL)) {
+         return sp[i + 1 + 6];
+      }
+   }
+   return 0;
+}
+
+#elif defined(__AVR__)
+
+#define SYST_ISR_ATTR
+
+typedef volatile uint8_t* SysPortReg;
+typedef uint8_t           SysPortMask;
+
+inline bool sysPortLookup(const uint8_t pin, SysPortReg& reg, SysPortMask& mask) {
+   uint8_t port = digitalPinToPort(pin);
+
+   if (port == NOT_A_PORT) {
+      return false;
+   }
+   reg = portOutputRegister(port);
+   mask = digitalPinToBitMask(pin);
+   return true;
+}
+
+// these are read-modify-write, so they must be called with interrupts disabled (e.g. in a timer callback)
+inline void sysPortSet(const SysPortReg reg, const SysPortMask mask) {
+   *reg |= mask;
+}
+
+inline void sysPortClear(const SysPortReg reg, const SysPortMask mask) {
+   *reg &= ~mask;
+}
+
+// inputs are read from the PINx register rather than the PORTx output register
+inline bool sysPortInputLookup(const uint8_t pin, SysPortReg& reg, SysPortMask& mask) {
+   uint8_t port = digitalPinToPort(pin);
+
+   if (port == NOT_A_PORT) {
+      return false;
+   }
+   reg = portInputRegister(port);
+   mask = digitalPinToBitMask(pin);
+   return true;
+}
+
+inline SysPortMask sysPortRead(const SysPortReg reg) {
+   return *reg;
+}
+
+/*
+the timer vectors save the stack pointer after pushing one register (see SysTimer_AVR.cpp), so the return address
+pushed by the interrupt is just above that, high byte first, as a word address
+*/
+inline uint32_t sysInterruptedPC(void) {
+   volatile uint8_t* sp = reinterpret_cast<volatile uint8_t*>(_AVRInterruptSP);
+#if defined(__AVR_3_BYTE_PC__)
+   uint32_t pc = (static_cast<uint32_t>(sp[2]) << 16) | (static_cast<uint32_t>(sp[3]) << 8) | sp[4];
+#else
+   uint32_t pc = (static_cast<uint32_t>(sp[2]) << 8) | sp[3];
+#endif
+   return pc << 1;
+}
+
+#endif // architecture
+
+#endif //header protect
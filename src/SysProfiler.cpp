@@ -0,0 +1,113 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysProfiler.h>
+
+// timer callback: take one sample
+void SYST_ISR_ATTR _SysProfilerHandler(void* arg) {
+   SysProfiler* that = static_cast<SysProfiler*>(arg);
+   uint32_t     index;
+
+   if (that->_mode == ProfileMode::P_TAG) {
+      index = that->_tag;
+   } else {
+      index = (sysInterruptedPC() - that->_start) >> that->_shift;          // addresses below the range wrap round to large indices
+   }
+   that->_samples = that->_samples + 1;
+   if (index >= that->_count) {
+      that->_outside = that->_outside + 1;
+      return;
+   }
+   if (++that->_buckets[index] == 0xFFFF) {
+      for (uint16_t i = 0; i < that->_count; i++) {
+         that->_buckets[i] >>= 1;
+      }
+      that->_samples = that->_samples >> 1;
+      that->_outside = that->_outside >> 1;
+   }
+}
+
+/*
+start sampling every intervalUs usec. In P_ADDRESS mode, the addresses from start up to (but not including) end are
+divided among the buckets
+
+the interval should not be a multiple of the period of anything else the sketch does regularly, or the samples
+will keep landing on the same part of it
+*/
+bool SysProfiler::begin(const uint32_t intervalUs, const ProfileMode mode, const uint32_t start, const uint32_t end) {
+   if (!_timer.begin() || (_buckets == nullptr) || (_count == 0) || (end <= start)) {
+      return false;
+   }
+   _mode = mode;
+   _start = 0;
+   _shift = 0;
+   if (mode == ProfileMode::P_ADDRESS) {
+      _start = start;
+      while (((end - start - 1) >> _shift) >= _count) {
+         ++_shift;
+      }
+   }
+   clear();
+   _timer.attachInterrupt(_SysProfilerHandler, this);
+   _timer.setIntervalMicros(intervalUs);
+   return _timer.arm(true);
+}
+
+void SysProfiler::end(void) {
+   _timer.disarm();
+}
+
+void SysProfiler::clear(void) {
+   noInterrupts();
+   for (uint16_t i = 0; i < _count; i++) {
+      _buckets[i] = 0;
+   }
+   _samples = 0;
+   _outside = 0;
+   interrupts();
+}
+
+/*
+print the histogram for extras/sysprof.py: a header line, then the index and count of each bucket that is not empty
+
+# SysProfiler <address|tag> <start address in hex> <shift> <samples> <outside>
+<index> <count>
+*/
+void SysProfiler::dump(Print& out) {
+   out.print("# SysProfiler ");
+   out.print((_mode == ProfileMode::P_TAG) ? "tag " : "address ");
+   out.print(_start, HEX);
+   out.print(' ');
+   out.print(static_cast<unsigned long>(_shift));
+   out.print(' ');
+   out.print(getSamples());
+   out.print(' ');
+   out.println(getOutside());
+   for (uint16_t i = 0; i < _count; i++) {
+      noInterrupts();
+      uint16_t count = _buckets[i];
+      interrupts();
+      if (count > 0) {
+         out.print(static_cast<unsigned long>(i));
+         out.print(' ');
+         out.println(static_cast<unsigned long>(count));
+      }
+   }
+}
@@ -0,0 +1,103 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysProfiler_H_
+#define _SysProfiler_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+// default address range profiled: all of flash
+#if defined(__AVR__)
+#define SYST_PROFILE_START     0UL
+#define SYST_PROFILE_END       (FLASHEND + 1UL)
+#elif defined(__SAM3X8E__)
+#define SYST_PROFILE_START     IFLASH0_ADDR
+#define SYST_PROFILE_END       (IFLASH0_ADDR + IFLASH0_SIZE + IFLASH1_SIZE)
+#elif defined(ESP8266)
+#define SYST_PROFILE_START     0x40200000UL      // code in flash: code in IRAM (0x40100000) is counted as outside
+#define SYST_PROFILE_END       0x40300000UL
+#endif
+
+enum class ProfileMode { P_ADDRESS, P_TAG };
+
+/*
+a statistical profiler: a fast SysTimer interrupt samples where the program is, and counts the samples in a histogram
+
+P_ADDRESS: the interrupted address is counted in the bucket for its part of the address range. The buckets are all
+the same power of 2 in size, the smallest that covers the range, so the histogram can be mapped back to functions
+with the symbols from the ELF file (see extras/sysprof.py)
+P_TAG: the tag last set with setTag() is counted, for profiling by regions of your own choosing
+
+the more buckets the sketch gives it, the smaller each bucket's share of the address range. When a bucket fills up,
+all the counts are halved, so the histogram keeps its shape however long the profiler runs
+*/
+class SysProfiler {
+public:
+   SysProfiler(SysTimer& timer, uint16_t* buckets, const uint16_t count) : _timer(timer), _buckets(buckets), _count(count) {}
+
+   bool     begin(const uint32_t intervalUs, const ProfileMode mode = ProfileMode::P_ADDRESS,
+                  const uint32_t start = SYST_PROFILE_START, const uint32_t end = SYST_PROFILE_END);
+   void     end(void);
+   void     clear(void);
+   void     dump(Print& out);
+
+   // the region being run, counted in P_TAG mode: tags of count or more are counted as outside
+   void setTag(const uint16_t tag) {
+      SYST_LOCK();
+      _tag = tag;
+      SYST_UNLOCK();
+   }
+
+   // address range of each bucket, as a power of 2
+   uint8_t getShift(void) const {
+      return _shift;
+   }
+
+   uint32_t getSamples(void) const {
+      SYST_LOCK();
+      uint32_t samples = _samples;
+      SYST_UNLOCK();
+      return samples;
+   }
+
+   // samples outside the address range or tags
+   uint32_t getOutside(void) const {
+      SYST_LOCK();
+      uint32_t outside = _outside;
+      SYST_UNLOCK();
+      return outside;
+   }
+
+private:
+   SysTimer&            _timer;
+   uint16_t*            _buckets;
+   uint16_t             _count;
+   ProfileMode          _mode = ProfileMode::P_ADDRESS;
+   uint32_t             _start = 0;
+   uint8_t              _shift = 0;
+   volatile uint16_t    _tag = 0;
+   volatile uint32_t    _samples = 0;
+   volatile uint32_t    _outside = 0;
+
+   friend void _SysProfilerHandler(void* arg);
+};
+
+#endif //header protect
@@ -0,0 +1,134 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysRateLimiter.h>
+
+/*
+atomic bucket updates
+
+SAM: LDREXB/STREXB retry until no other update (including an interrupt, since exception entry clears the exclusive
+monitor) has come between the load and the store, so nothing is ever blocked
+AVR: a byte update is only a few instructions, so we disable interrupts around it and restore SREG afterwards,
+which also makes it safe to call from an interrupt handler
+ESP8266: the core has no atomic read-modify-write, so we raise the interrupt level around it in the same way
+*/
+#if defined(__SAM3X8E__)
+static inline bool SYST_ISR_ATTR takeTokens(volatile uint8_t* tokens, const uint8_t count) {
+   uint8_t value;
+
+   do {
+      value = __LDREXB(tokens);
+      if (value < count) {
+         __CLREX();
+         return false;
+      }
+   } while (__STREXB(value - count, tokens));
+   return true;
+}
+
+static inline void SYST_ISR_ATTR addTokens(volatile uint8_t* tokens, const uint8_t count, const uint8_t limit) {
+   uint8_t value;
+
+   do {
+      value = __LDREXB(tokens);
+      value = ((limit - value) > count) ? (value + count) : limit;
+   } while (__STREXB(value, tokens));
+}
+
+#else
+static inline bool SYST_ISR_ATTR takeTokens(volatile uint8_t* tokens, const uint8_t count) {
+   bool taken = false;
+
+   SYST_LOCK();
+   if (*tokens >= count) {
+      *tokens -= count;
+      taken = true;
+   }
+   SYST_UNLOCK();
+   return taken;
+}
+
+static inline void SYST_ISR_ATTR addTokens(volatile uint8_t* tokens, const uint8_t count, const uint8_t limit) {
+   SYST_LOCK();
+   uint8_t value = *tokens;
+   *tokens = ((limit - value) > count) ? (value + count) : limit;
+   SYST_UNLOCK();
+}
+#endif
+
+// timer callback: top up every bucket that is not already full
+void SYST_ISR_ATTR _SysRateLimiterHandler(void* arg) {
+   SysRateLimiter* that = static_cast<SysRateLimiter*>(arg);
+   SysBucket*      bucket = that->_buckets;
+
+   for (uint16_t i = 0; i < that->_count; i++, bucket++) {
+      if ((bucket->refill > 0) && (bucket->tokens < bucket->burst)) {
+         addTokens(&bucket->tokens, bucket->refill, bucket->burst);
+      }
+   }
+}
+
+/*
+refill the buckets every tickMs msec. Buckets start with no rate, so nothing can be acquired until setRate is called
+*/
+bool SysRateLimiter::begin(const uint32_t tickMs) {
+   if (!_timer.begin() || (_buckets == nullptr)) {
+      return false;
+   }
+   for (uint16_t i = 0; i < _count; i++) {
+      _buckets[i].tokens = 0;
+      _buckets[i].burst = 0;
+      _buckets[i].refill = 0;
+   }
+   _timer.attachInterrupt(_SysRateLimiterHandler, this);
+   _timer.setInterval(tickMs);
+   return _timer.arm(true);
+}
+
+void SysRateLimiter::end(void) {
+   _timer.disarm();
+}
+
+/*
+allow refill tokens per tick, with bursts of up to burst tokens. The bucket starts full
+*/
+bool SysRateLimiter::setRate(const uint16_t bucket, const uint8_t refill, const uint8_t burst) {
+   if (bucket >= _count) {
+      return false;
+   }
+   SYST_LOCK();
+   _buckets[bucket].refill = refill;
+   _buckets[bucket].burst = burst;
+   _buckets[bucket].tokens = burst;
+   SYST_UNLOCK();
+   return true;
+}
+
+/*
+take tokens from the bucket if it holds enough of them
+
+returns false, without taking any, if it does not
+*/
+bool SYST_ISR_ATTR SysRateLimiter::tryAcquire(const uint16_t bucket, const uint8_t tokens) {
+   if (bucket >= _count) {
+      return false;
+   }
+   return takeTokens(&_buckets[bucket].tokens, tokens);
+}
@@ -0,0 +1,71 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysRateLimiter_H_
+#define _SysRateLimiter_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+/*
+one token bucket: 3 bytes, with no padding, so a large table of buckets is compact and the refill walks it in order
+*/
+struct SysBucket {
+   volatile uint8_t tokens;
+   uint8_t          burst;                      // most tokens the bucket can hold
+   uint8_t          refill;                     // tokens added on each tick
+};
+
+/*
+token bucket rate limiters, refilled together by one SysTimer tick
+
+rather than each acquire working out how long it has been since the last one, the timer callback tops up every
+bucket on each tick, so tryAcquire() is just a compare and decrement. This is made atomic with the platform's
+cheapest primitive (exclusive load/store on the Due, a short interrupt-disabled section elsewhere), so it may be
+called from loop() and from interrupt handlers alike
+
+the sketch declares the SysBucket array, and each bucket is named by its index in it (e.g. a channel number)
+*/
+class SysRateLimiter {
+public:
+   SysRateLimiter(SysTimer& timer, SysBucket* buckets, const uint16_t count) : _timer(timer), _buckets(buckets), _count(count) {}
+
+   bool     begin(const uint32_t tickMs = 100);
+   void     end(void);
+   bool     setRate(const uint16_t bucket, const uint8_t refill, const uint8_t burst);
+   bool     tryAcquire(const uint16_t bucket, const uint8_t tokens = 1);
+
+   uint8_t available(const uint16_t bucket) const {
+      return (bucket < _count) ? _buckets[bucket].tokens : 0;
+   }
+
+   uint16_t getCount(void) const {
+      return _count;
+   }
+
+private:
+   SysTimer&   _timer;
+   SysBucket*  _buckets;
+   uint16_t    _count;
+
+   friend void _SysRateLimiterHandler(void* arg);
+};
+
+#endif //header protect
@@ -0,0 +1,153 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysSampler.h>
+
+#if defined(__AVR__)
+/*
+ADC channel for an analog pin, as analogRead() does it
+*/
+static uint8_t adcChannel(uint8_t pin) {
+#if defined(analogPinToChannel)
+#if defined(__AVR_ATmega32U4__)
+   if (pin >= 18) pin -= 18;
+#endif
+   pin = analogPinToChannel(pin);
+#elif defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+   if (pin >= 54) pin -= 54;
+#else
+   if (pin >= 14) pin -= 14;
+#endif
+   return pin;
+}
+
+// select the channel (with the AVcc reference) and start a conversion
+static inline void startConversion(const uint8_t channel) {
+#if defined(MUX5)
+   ADCSRB = (ADCSRB & ~_BV(MUX5)) | (((channel >> 3) & 0x01) << MUX5);
+#endif
+   ADMUX = _BV(REFS0) | (channel & 0x07);
+   ADCSRA |= _BV(ADSC);
+}
+#endif
+
+/*
+timer callback: take one sample from the current input and move on to the next one
+
+when a buffer is full, it is handed to loop() if loop() has released the other one, and the callback moves on to the
+other buffer. Otherwise the samples are discarded and the buffer is refilled
+
+both a discarded buffer and a tick that finds the ADC still busy count as an overrun, so a sketch that sees fewer
+samples than it expected can tell why
+*/
+void SYST_ISR_ATTR _SysSamplerHandler(void* arg) {
+   SysSampler* that = static_cast<SysSampler*>(arg);
+   uint8_t     next = that->_channel + 1;
+
+   if (next == that->_channels) {
+      next = 0;
+   }
+#if defined(__AVR__)
+   if (!that->_converting) {
+      // nothing to collect yet (the first tick)
+      startConversion(that->_pin[that->_channel]);
+      that->_converting = true;
+      return;
+   }
+   if (ADCSRA & _BV(ADSC)) {
+      // the period is shorter than a conversion, so this tick's sample is lost
+      ++that->_overruns;
+      return;
+   }
+   uint16_t sample = ADC;
+   startConversion(that->_pin[next]);
+#else
+   uint16_t sample = analogRead(that->_pin[that->_channel]);
+#endif
+   that->_channel = next;
+
+   that->_buffer[that->_fill][that->_count++] = sample;
+   if (that->_count == that->_length) {
+      that->_count = 0;
+      if (that->_ready < 0) {
+         that->_ready = that->_fill;
+         that->_fill ^= 1;
+      } else {
+         ++that->_overruns;
+      }
+   }
+}
+
+/*
+add an analog input (A0, A1 etc.)
+
+returns the input number, or -1 if there are no inputs left or the sampler is running
+*/
+int8_t SysSampler::attach(const uint8_t pin) {
+   if ((_channels >= SYST_SAMPLE_CHANNELS) || _timer.armed()) {
+      return -1;
+   }
+#if defined(__AVR__)
+   _pin[_channels] = adcChannel(pin);
+#else
+   _pin[_channels] = pin;
+#endif
+   return _channels++;
+}
+
+/*
+start taking one sample every periodMicros usec, so each input is sampled every (periodMicros x number of inputs)
+*/
+bool SysSampler::begin(const uint32_t periodMicros) {
+   if (!_timer.begin() || (_channels == 0)) {
+      return false;
+   }
+   _length = (SYST_SAMPLE_BUFFER / _channels) * _channels;
+   _channel = 0;
+   _converting = false;
+   _fill = 0;
+   _count = 0;
+   _ready = -1;
+#if defined(__AVR__)
+   ADCSRA |= _BV(ADEN);
+#endif
+   _timer.attachInterrupt(_SysSamplerHandler, this);
+   _timer.setIntervalMicros(periodMicros);
+   return _timer.arm(true);
+}
+
+void SysSampler::end(void) {
+   _timer.disarm();
+}
+
+/*
+returns a full buffer of getLength() samples, in input order (input 0, 1, ... 0, 1, ...), or nullptr if there is none
+the buffer belongs to loop() until it is released, so it can be processed in place
+*/
+const uint16_t* SysSampler::available(void) {
+   int8_t ready = _ready;
+
+   return (ready >= 0) ? _buffer[ready] : nullptr;
+}
+
+// hand the buffer back to the callback
+void SysSampler::release(void) {
+   _ready = -1;
+}
@@ -0,0 +1,90 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysSampler_H_
+#define _SysSampler_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+#define SYST_SAMPLE_CHANNELS   8                // maximum number of analog inputs per sampler
+
+#if defined(__AVR__)
+#define SYST_SAMPLE_BUFFER     32               // samples per buffer
+#else
+#define SYST_SAMPLE_BUFFER     256
+#endif
+
+/*
+samples analog inputs at a fixed rate, one input per timer tick in rotation, into a pair of buffers
+
+the callback fills one buffer while loop() owns the other, so a full buffer is handed to loop() without copying and
+loop() only has to wake up once per buffer. If loop() has not released its buffer by the time the other one is full,
+the new samples are discarded and counted as an overrun
+
+on the AVR the callback starts a conversion and collects it on the next tick, so it does not wait for the ADC: the
+tick period must be longer than a conversion (about 104 usec at 16MHz), and a tick that finds the conversion still
+running is also counted as an overrun
+*/
+class SysSampler {
+public:
+   explicit SysSampler(SysTimer& timer) : _timer(timer) {}
+
+   int8_t          attach(const uint8_t pin);
+   bool            begin(const uint32_t periodMicros);
+   void            end(void);
+   const uint16_t* available(void);
+   void            release(void);
+
+   // samples in each buffer: a whole number of rounds of all the inputs, so buffers always start with input 0
+   uint16_t getLength(void) const {
+      return _length;
+   }
+
+   uint8_t getChannels(void) const {
+      return _channels;
+   }
+
+   uint16_t getOverruns(void) const {
+      SYST_LOCK();
+      uint16_t overruns = _overruns;
+      SYST_UNLOCK();
+      return overruns;
+   }
+
+private:
+   SysTimer&          _timer;
+
+   uint8_t            _channels = 0;
+   uint8_t            _pin[SYST_SAMPLE_CHANNELS];
+   uint8_t            _channel = 0;                          // input being sampled
+   bool               _converting = false;                   // AVR: a conversion has been started for _channel
+
+   uint16_t           _buffer[2][SYST_SAMPLE_BUFFER];
+   uint16_t           _length = 0;
+   uint8_t            _fill = 0;                             // buffer the callback is filling
+   uint16_t           _count = 0;                            // samples in it
+   volatile int8_t    _ready = -1;                           // buffer owned by loop(), or -1
+   volatile uint16_t  _overruns = 0;
+
+   friend void _SysSamplerHandler(void* arg);
+};
+
+#endif //header protect
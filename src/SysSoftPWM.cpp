@@ -0,0 +1,223 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysSoftPWM.h>
+
+/*
+timer callback: at the start of the period switch to the pending frame and set every pin that is on, then clear
+the pins for this edge time and retune the timer to the next one
+
+retuning from the callback moves the next interrupt relative to this one rather than to now, so interrupt latency
+does not accumulate over the period
+*/
+void SYST_ISR_ATTR _SysSoftPWMHandler(void* arg) {
+   SysSoftPWM* that = static_cast<SysSoftPWM*>(arg);
+   uint16_t    now = that->_position;
+
+   if (now == 0) {
+      if (that->_pending) {
+         that->_active ^= 1;
+         that->_pending = false;
+      }
+      const SysPWMFrame& frame = that->_frame[that->_active];
+      for (uint8_t p = 0; p < that->_ports; p++) {
+         sysPortSet(that->_portReg[p], frame.on[p]);
+         sysPortClear(that->_portReg[p], that->_portPins[p] & ~frame.on[p]);
+      }
+      that->_next = 0;
+   }
+
+   const SysPWMFrame& frame = that->_frame[that->_active];
+   uint8_t i = that->_next;
+
+   while ((i < frame.count) && (frame.time[i] == now)) {
+      sysPortClear(that->_portReg[frame.port[i]], frame.off[i]);
+      ++i;
+   }
+   that->_next = i;
+
+   uint16_t next = (i < frame.count) ? frame.time[i] : that->_period;
+   if (!that->_timer.retuneMicros(next - now)) {
+      // the edge cannot be placed, so stop with the pins low rather than switch them at the wrong times
+      that->_timer.disarm();
+      that->_running = false;
+      for (uint8_t p = 0; p < that->_ports; p++) {
+         sysPortClear(that->_portReg[p], that->_portPins[p]);
+      }
+      return;
+   }
+   that->_position = (next < that->_period) ? next : 0;
+}
+
+/*
+build the idle frame from the current duty values and mark it pending
+
+the callback only switches frames while _pending is set, so clearing it first means the idle frame cannot become
+active while it is being rebuilt
+*/
+void SysSoftPWM::build(void) {
+   uint16_t times[SYST_PWM_CHANNELS];
+   uint8_t  order[SYST_PWM_CHANNELS];
+   uint8_t  edges = 0;
+
+   _pending = false;
+   SysPWMFrame& frame = _frame[_active ^ 1];
+
+   for (uint8_t p = 0; p < SYST_PWM_PORTS; p++) {
+      frame.on[p] = 0;
+   }
+   for (uint8_t ch = 0; ch < _channels; ch++) {
+      if (_duty[ch] == 0) {
+         continue;
+      }
+      frame.on[_channelPort[ch]] |= _channelMask[ch];
+      if (_duty[ch] == 255) {
+         continue;
+      }
+      uint32_t t = ((static_cast<uint32_t>(_duty[ch]) * _period) + 127) / 255;
+      t = constrain(t, static_cast<uint32_t>(SYST_PWM_MIN_GAP), static_cast<uint32_t>(_period - SYST_PWM_MIN_GAP));
+
+      // insertion sort: there are only a few channels, and this runs in loop() rather than the callback
+      uint8_t i = edges++;
+      while ((i > 0) && (times[i - 1] > t)) {
+         times[i] = times[i - 1];
+         order[i] = order[i - 1];
+         --i;
+      }
+      times[i] = static_cast<uint16_t>(t);
+      order[i] = ch;
+   }
+
+   // group edges less than the minimum gap apart at the time of the first, with one entry per port in each group
+   uint16_t groupTime = 0;
+   uint8_t  groupStart = 0;
+
+   frame.count = 0;
+   for (uint8_t i = 0; i < edges; i++) {
+      uint8_t ch = order[i];
+      if ((i == 0) || ((times[i] - groupTime) >= SYST_PWM_MIN_GAP)) {
+         groupTime = times[i];
+         groupStart = frame.count;
+      }
+      uint8_t e = groupStart;
+      while ((e < frame.count) && (frame.port[e] != _channelPort[ch])) {
+         ++e;
+      }
+      if (e == frame.count) {
+         frame.time[e] = groupTime;
+         frame.port[e] = _channelPort[ch];
+         frame.off[e] = 0;
+         ++frame.count;
+      }
+      frame.off[e] |= _channelMask[ch];
+   }
+   _pending = true;
+}
+
+/*
+start the PWM period (usec) on the timer. Pins are low for the first period
+
+returns false if the timer could not be allocated, cannot be retuned to the usec (see SysTimerBase::canRetune), or the
+period is too short for the minimum edge gap
+*/
+bool SysSoftPWM::begin(const uint16_t period) {
+   if (!_timer.begin() || !_timer.canRetune() || (period < (4 * SYST_PWM_MIN_GAP))) {
+      return false;
+   }
+   if (_running) {
+      end();
+   }
+   _period = period;
+   _position = 0;
+   _next = 0;
+   _frame[_active].count = 0;
+   for (uint8_t p = 0; p < SYST_PWM_PORTS; p++) {
+      _frame[_active].on[p] = 0;
+   }
+   build();
+   _timer.attachInterrupt(_SysSoftPWMHandler, this);
+   _timer.setIntervalMicros(_period);
+   _running = _timer.arm(true);
+   return _running;
+}
+
+// stop the timer and set all the pins low
+void SysSoftPWM::end(void) {
+   _timer.disarm();
+   _running = false;
+   noInterrupts();
+   for (uint8_t p = 0; p < _ports; p++) {
+      sysPortClear(_portReg[p], _portPins[p]);
+   }
+   interrupts();
+}
+
+/*
+add a pin as an output with a duty of 0
+
+returns the channel number, or -1 if there are no channels left or the pin is on a port we have no room for
+*/
+int8_t SysSoftPWM::attach(const uint8_t pin) {
+   SysPortReg  reg;
+   SysPortMask mask;
+   uint8_t     p = 0;
+
+   if ((_channels >= SYST_PWM_CHANNELS) || !sysPortLookup(pin, reg, mask)) {
+      return -1;
+   }
+   while ((p < _ports) && (_portReg[p] != reg)) {
+      ++p;
+   }
+   if (p == SYST_PWM_PORTS) {
+      return -1;
+   }
+   pinMode(pin, OUTPUT);
+   digitalWrite(pin, LOW);
+
+   noInterrupts();
+   if (p == _ports) {
+      _portReg[p] = reg;
+      _portPins[p] = 0;
+      ++_ports;
+   }
+   _portPins[p] |= mask;
+   interrupts();
+
+   _channelPort[_channels] = p;
+   _channelMask[_channels] = mask;
+   _duty[_channels] = 0;
+   return _channels++;
+}
+
+/*
+set the duty from 0 (always off) to 255 (always on), which takes effect at the start of the next period
+
+returns false for an invalid channel
+*/
+bool SysSoftPWM::setDuty(const int8_t channel, const uint8_t duty) {
+   if ((channel < 0) || (channel >= _channels)) {
+      return false;
+   }
+   _duty[channel] = duty;
+   if (_period > 0) {
+      build();
+   }
+   return true;
+}
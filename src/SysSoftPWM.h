@@ -0,0 +1,112 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysSoftPWM_H_
+#define _SysSoftPWM_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+#define SYST_PWM_CHANNELS    16              // maximum number of PWM pins per engine
+#define SYST_PWM_PORTS       4               // maximum number of distinct ports those pins may be on
+
+/*
+edges closer together than this (usec) are switched in the same interrupt, since the timer could not be retuned
+in time for the second one. It is also the shortest on or off time for duty values other than 0 and 255
+*/
+#if defined(ESP8266)
+#define SYST_PWM_MIN_GAP     20
+#elif defined(__SAM3X8E__)
+#define SYST_PWM_MIN_GAP     10
+#else
+#define SYST_PWM_MIN_GAP     40
+#endif
+
+/*
+one PWM period, built in loop() and switched by the timer callback
+
+all pins with a non-zero duty are set at the start of the period; each entry then clears the pins on one port at
+the given time, so pins on the same port that switch together take a single register write
+*/
+struct SysPWMFrame {
+   uint8_t     count;                                  // number of entries
+   uint16_t    time[SYST_PWM_CHANNELS];                // usec from the start of the period, ascending
+   uint8_t     port[SYST_PWM_CHANNELS];
+   SysPortMask off[SYST_PWM_CHANNELS];
+   SysPortMask on[SYST_PWM_PORTS];                     // pins set at the start of the period, per port
+};
+
+/*
+N-channel software PWM driven by one SysTimer
+
+rather than interrupting at a fixed tick and scanning every channel, the timer is retuned after each interrupt
+to the next edge in the sorted frame, so the interrupt rate depends only on the number of distinct edge times
+
+duty changes are built into the idle frame and take effect at the next period boundary, so a period is never
+switched part way through
+*/
+class SysSoftPWM {
+public:
+   explicit SysSoftPWM(SysTimer& timer) : _timer(timer) {}
+
+   bool     begin(const uint16_t period);
+   void     end(void);
+   int8_t   attach(const uint8_t pin);
+   bool     setDuty(const int8_t channel, const uint8_t duty);
+
+   uint8_t getDuty(const int8_t channel) const {
+      return ((channel >= 0) && (channel < _channels)) ? _duty[channel] : 0;
+   }
+
+   uint16_t getPeriod(void) const {
+      return _period;
+   }
+
+   uint8_t getChannels(void) const {
+      return _channels;
+   }
+
+private:
+   void build(void);
+
+   SysTimer&         _timer;
+   uint16_t          _period = 0;                      // usec
+   volatile bool     _running = false;                 // cleared by the callback if the timer cannot be retuned
+
+   uint8_t           _ports = 0;
+   SysPortReg        _portReg[SYST_PWM_PORTS];
+   SysPortMask       _portPins[SYST_PWM_PORTS];         // all PWM pins on each port
+
+   uint8_t           _channels = 0;
+   uint8_t           _channelPort[SYST_PWM_CHANNELS];
+   SysPortMask       _channelMask[SYST_PWM_CHANNELS];
+   uint8_t           _duty[SYST_PWM_CHANNELS];
+
+   SysPWMFrame       _frame[2];
+   volatile uint8_t  _active = 0;                      // frame the callback is switching
+   volatile bool     _pending = false;                 // the other frame is complete and should be switched to
+
+   uint8_t           _next = 0;                        // next entry in the active frame
+   uint16_t          _position = 0;                    // time in the period of the interrupt being handled
+
+   friend void _SysSoftPWMHandler(void* arg);
+};
+
+#endif //header protect
@@ -0,0 +1,226 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysStateMachine.h>
+
+/*
+SysTimeoutManager expiry callback, for all the machines that share the manager: the timeout's context is the machine
+
+a transition made for one timeout may cancel others in the same batch, in which case their context is gone
+*/
+void _SysStateMachineExpired(const SysTimeoutHandle* expired, const uint8_t count, void* arg) {
+   SysTimeoutManager* manager = static_cast<SysTimeoutManager*>(arg);
+
+   for (uint8_t i = 0; i < count; i++) {
+      SysStateMachine* machine = static_cast<SysStateMachine*>(manager->getContext(expired[i]));
+
+      if (machine != nullptr) {
+         machine->expired(expired[i]);
+      }
+   }
+}
+
+// nesting depth of a state, or 0 if it is not a valid state or is nested too deeply
+uint8_t SysStateMachine::depthOf(uint8_t state) const {
+   uint8_t depth = 0;
+
+   while (state != SYST_HSM_NONE) {
+      if ((state >= _stateCount) || (depth == SYST_HSM_DEPTH)) {
+         return 0;
+      }
+      ++depth;
+      state = _states[state].parent;
+   }
+   return depth;
+}
+
+/*
+check the tables and enter the initial state (and its initial substates). arg is passed to the entry, exit and
+action functions
+
+returns false if a state is nested more than SYST_HSM_DEPTH deep, has an initial substate that is not its child, or
+refers to a state that does not exist
+*/
+bool SysStateMachine::begin(const uint8_t initial, void* arg) {
+   if ((_states == nullptr) || (depthOf(initial) == 0)) {
+      return false;
+   }
+   for (uint8_t s = 0; s < _stateCount; s++) {
+      const SysState& state = _states[s];
+
+      if ((depthOf(s) == 0) || ((state.initial != SYST_HSM_NONE) && ((state.initial >= _stateCount) || (_states[state.initial].parent != s))) ||
+          ((state.timeoutMs > 0) && (state.timeoutTarget >= _stateCount))) {
+         return false;
+      }
+   }
+   for (uint16_t t = 0; t < _transitionCount; t++) {
+      const SysTransition& trans = _transitions[t];
+
+      if ((trans.state >= _stateCount) || ((trans.target != SYST_HSM_NONE) && (trans.target >= _stateCount))) {
+         return false;
+      }
+   }
+   while (_depth > 0) {
+      exit();                                               // begin() called again
+   }
+   _arg = arg;
+   _timeouts.onExpire(_SysStateMachineExpired, &_timeouts);
+   transition(initial, nullptr);
+   return true;
+}
+
+/*
+queue an event: this may be called from an interrupt handler
+
+returns false, and counts an overrun, if the queue is full
+*/
+bool SYST_ISR_ATTR SysStateMachine::post(const uint8_t event) {
+   return _queue.post(event);
+}
+
+/*
+handle the queued events: call this from loop()
+
+events posted while this runs (e.g. by an entry function) are handled too, up to SYST_MAILBOX_SIZE of them in all,
+so a machine that keeps posting to itself cannot hold up loop()
+
+returns the number of events handled
+*/
+uint8_t SysStateMachine::dispatch(void) {
+   uint8_t  handled = 0;
+   SysEvent event;
+
+   while ((handled < SYST_MAILBOX_SIZE) && _queue.receive(event)) {
+      handle(event.type);
+      ++handled;
+   }
+   return handled;
+}
+
+// true if the state is active, either as the innermost state or as one of its ancestors
+bool SysStateMachine::inState(const uint8_t state) const {
+   for (uint8_t d = 0; d < _depth; d++) {
+      if (_path[d] == state) {
+         return true;
+      }
+   }
+   return false;
+}
+
+// look for a transition from the innermost state outwards, so a substate overrides its ancestors
+void SysStateMachine::handle(const uint8_t event) {
+   for (uint8_t d = _depth; d > 0; d--) {
+      uint8_t state = _path[d - 1];
+
+      for (uint16_t t = 0; t < _transitionCount; t++) {
+         const SysTransition& trans = _transitions[t];
+
+         if ((trans.state == state) && (trans.event == event)) {
+            if (trans.target == SYST_HSM_NONE) {
+               if (trans.action != nullptr) {
+                  (*trans.action)(_arg);
+               }
+            } else {
+               transition(trans.target, trans.action);
+            }
+            return;
+         }
+      }
+   }
+}
+
+/*
+exit the active states up to the common ancestor of the innermost state and target, then enter the states down to
+target and its initial substates. A transition to an active state (including the innermost one) exits and re-enters
+it, which also restarts its timeout
+*/
+void SysStateMachine::transition(const uint8_t target, const StateFunc action) {
+   uint8_t targetPath[SYST_HSM_DEPTH];
+   uint8_t targetDepth = depthOf(target);
+   uint8_t common = 0;
+
+   for (uint8_t d = targetDepth, state = target; d > 0; d--) {
+      targetPath[d - 1] = state;
+      state = _states[state].parent;
+   }
+   while ((common < _depth) && (common < targetDepth) && (_path[common] == targetPath[common])) {
+      ++common;
+   }
+   if (common == targetDepth) {
+      --common;
+   }
+   while (_depth > common) {
+      exit();
+   }
+   if (action != nullptr) {
+      (*action)(_arg);
+   }
+   while (_depth < targetDepth) {
+      enter(targetPath[_depth]);
+   }
+   while (_states[getState()].initial != SYST_HSM_NONE) {
+      enter(_states[getState()].initial);
+   }
+}
+
+void SysStateMachine::enter(const uint8_t state) {
+   const SysState& entered = _states[state];
+   uint8_t         depth = _depth++;
+
+   _path[depth] = state;
+   _timeout[depth] = SYST_TIMEOUT_INVALID;
+   if (entered.onEntry != nullptr) {
+      (*entered.onEntry)(_arg);
+   }
+   if (entered.timeoutMs > 0) {
+      _policy[depth].baseMs = entered.timeoutMs;
+      _policy[depth].maxMs = entered.timeoutMs;
+      _policy[depth].maxRetries = 0;
+      _policy[depth].jitter = false;
+      _timeout[depth] = _timeouts.start(_policy[depth], this);
+      if ((_timeout[depth] == SYST_TIMEOUT_INVALID) && (_timeoutFailures < 0xFF)) {
+         _timeoutFailures++;                                // the state stays in force until an event leaves it
+      }
+   }
+}
+
+// exit the innermost state
+void SysStateMachine::exit(void) {
+   uint8_t depth = --_depth;
+
+   if (_timeout[depth] != SYST_TIMEOUT_INVALID) {
+      _timeouts.cancel(_timeout[depth]);
+      _timeout[depth] = SYST_TIMEOUT_INVALID;
+   }
+   if (_states[_path[depth]].onExit != nullptr) {
+      (*_states[_path[depth]].onExit)(_arg);
+   }
+}
+
+// an active state's timeout has expired: its timeout transition is handled like any other
+void SysStateMachine::expired(const SysTimeoutHandle handle) {
+   for (uint8_t d = 0; d < _depth; d++) {
+      if (_timeout[d] == handle) {
+         _timeout[d] = SYST_TIMEOUT_INVALID;
+         transition(_states[_path[d]].timeoutTarget, nullptr);
+         return;
+      }
+   }
+}
@@ -0,0 +1,122 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysStateMachine_H_
+#define _SysStateMachine_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+#include <SysTimeoutManager.h>
+#include <SysMailbox.h>
+
+#define SYST_HSM_DEPTH         4                 // deepest nesting of states
+#define SYST_HSM_NONE          0xFF              // no state
+
+typedef void (*StateFunc)(void* arg);
+
+/*
+one state: its parent (SYST_HSM_NONE at the top level), the substate entered when it is the target of a transition
+(SYST_HSM_NONE if it has none), and an optional timeout: timeoutMs after the state is entered, the machine goes to
+timeoutTarget unless it has left the state by then
+*/
+struct SysState {
+   uint8_t   parent;
+   uint8_t   initial;
+   uint8_t   timeoutTarget;
+   uint32_t  timeoutMs;                         // 0 for no timeout
+   StateFunc onEntry;                           // either may be nullptr
+   StateFunc onExit;
+};
+
+/*
+event handled in state (or any of its substates that does not handle it): exit to the common ancestor, call action
+(may be nullptr), then enter target. With target SYST_HSM_NONE, just the action is called and the state is unchanged
+*/
+struct SysTransition {
+   uint8_t   state;
+   uint8_t   event;
+   uint8_t   target;
+   StateFunc action;
+};
+
+/*
+a table-driven hierarchical state machine
+
+the states and transitions are tables supplied by the sketch and indexed by state number. Each active state's
+timeout is a SysTimeoutManager timeout that is started when the state is entered and cancelled when it is left,
+so a state's timeout can never fire after the state has changed. A manager may be shared by any number of
+machines, but begin() takes over its expiry callback, so it should not be used for anything else
+
+events are posted to a SysMailbox, which may be done from an interrupt handler, and handled in dispatch(), called from
+loop(): each event is handled to completion, including any entry and exit functions, before the next one
+*/
+class SysStateMachine {
+public:
+   SysStateMachine(SysTimeoutManager& timeouts, const SysState* states, const uint8_t stateCount,
+                   const SysTransition* transitions, const uint16_t transitionCount) :
+      _timeouts(timeouts), _states(states), _stateCount(stateCount), _transitions(transitions), _transitionCount(transitionCount) {}
+
+   bool     begin(const uint8_t initial, void* arg = nullptr);
+   bool     post(const uint8_t event);
+   uint8_t  dispatch(void);
+   bool     inState(const uint8_t state) const;
+
+   // the innermost active state
+   uint8_t getState(void) const {
+      return (_depth > 0) ? _path[_depth - 1] : SYST_HSM_NONE;
+   }
+
+   // events dropped because the queue was full
+   uint8_t getOverruns(void) const {
+      return _queue.getOverruns();
+   }
+
+   // state timeouts that were never started because the manager's table was full
+   uint8_t getTimeoutFailures(void) const {
+      return _timeoutFailures;
+   }
+
+private:
+   void     handle(const uint8_t event);
+   void     transition(const uint8_t target, const StateFunc action);
+   void     enter(const uint8_t state);
+   void     exit(void);
+   void     expired(const SysTimeoutHandle handle);
+   uint8_t  depthOf(uint8_t state) const;
+
+   SysTimeoutManager&   _timeouts;
+   const SysState*      _states;
+   uint8_t              _stateCount;
+   const SysTransition* _transitions;
+   uint16_t             _transitionCount;
+   void*                _arg = nullptr;
+
+   uint8_t              _path[SYST_HSM_DEPTH];           // active states, outermost first
+   uint8_t              _depth = 0;
+   uint8_t              _timeoutFailures = 0;
+   SysTimeoutHandle     _timeout[SYST_HSM_DEPTH];
+   SysBackoff           _policy[SYST_HSM_DEPTH];
+
+   SysMailbox           _queue;
+
+   friend void _SysStateMachineExpired(const SysTimeoutHandle* expired, const uint8_t count, void* arg);
+};
+
+#endif //header protect
@@ -0,0 +1,164 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysStepper.h>
+
+/*
+timer callback: pulse the step pin and retune the timer to the next planned interval
+
+the step pin is held high for SYST_STEP_PULSE usec after the work is done, whichever path is taken: on the Due and
+the ESP8266 the callback itself can be over in well under the 1-2 usec step drivers need
+if run() has not kept the ring filled, the previous interval is kept rather than stalling the motor at speed
+*/
+void SYST_ISR_ATTR _SysStepperHandler(void* arg) {
+   SysStepper* that = static_cast<SysStepper*>(arg);
+
+   if (!that->_stepping) {
+      return;
+   }
+   sysPortSet(that->_stepReg, that->_stepMask);
+   that->_position += that->_direction;
+   if (--that->_toStep == 0) {
+      that->_stepping = false;
+   } else if (that->_tail != that->_head) {
+      that->_timer.retuneMicros(that->_ring[that->_tail]);
+      that->_tail = (that->_tail + 1) & (SYST_STEP_RING - 1);
+   } else {
+      ++that->_underruns;
+   }
+   delayMicroseconds(SYST_STEP_PULSE);
+   sysPortClear(that->_stepReg, that->_stepMask);
+}
+
+/*
+returns false if the timer could not be allocated or cannot be retuned to the usec (see SysTimerBase::canRetune),
+since the ramp would then run at a fixed rate, or the step pin is not supported
+*/
+bool SysStepper::begin(void) {
+   if (!_timer.begin() || !_timer.canRetune() || !sysPortLookup(_stepPin, _stepReg, _stepMask)) {
+      return false;
+   }
+   pinMode(_stepPin, OUTPUT);
+   digitalWrite(_stepPin, LOW);
+   pinMode(_dirPin, OUTPUT);
+   return _timer.attachInterrupt(_SysStepperHandler, this);
+}
+
+// the interval at full speed, in 1/256 usec
+void SysStepper::setMaxSpeed(const uint32_t stepsPerSec) {
+   _cMin = (stepsPerSec > 0) ? ((1000000UL * 256UL) / stepsPerSec) : 0;
+}
+
+/*
+the first interval of the ramp, in 1/256 usec: c0 = 0.676 * sqrt(2/a) sec
+the 0.676 corrects for the error of the recurrence at the first step (see AVR446)
+*/
+void SysStepper::setAcceleration(const uint32_t stepsPerSec2) {
+   _c0 = (stepsPerSec2 > 0) ? static_cast<uint32_t>(0.676 * 1000000.0 * 256.0 * sqrt(2.0 / stepsPerSec2)) : 0;
+}
+
+/*
+queue the intervals for as much of the move as the ring has room for
+
+accelerating: c[n] = c[n-1] - 2c[n-1]/(4n+1) until the interval reaches full speed
+decelerating: the same recurrence in reverse, c[n-1] = c[n] + 2c[n]/(4n-1), once there are only as many steps
+left as were used to accelerate, which brings the last step back to c0
+*/
+void SysStepper::plan(void) {
+   while (_toPlan > 0) {
+      uint8_t next = (_head + 1) & (SYST_STEP_RING - 1);
+      if (next == _tail) {
+         break;                                                // full
+      }
+      if (_rampStep == 0) {
+         _c = (_c0 > _cMin) ? _c0 : _cMin;
+         _rampStep = 1;
+      } else if ((_toPlan < _rampStep) && (_rampStep > 1)) {
+         _c += (2 * _c) / ((4 * _rampStep) - 5);
+         --_rampStep;
+      } else if (_c > _cMin) {
+         _c -= (2 * _c) / ((4 * _rampStep) + 1);
+         ++_rampStep;
+         if (_c < _cMin) {
+            _c = _cMin;
+         }
+      }
+      --_toPlan;
+
+      uint32_t usec = (_c + 128) >> 8;
+      _ring[_head] = static_cast<SysStepInterval>(constrain(usec, 1UL, SYST_STEP_MAX_INTERVAL));
+      _head = next;
+   }
+}
+
+/*
+start a relative move of the given number of steps, with the speed and acceleration set beforehand
+
+returns false if a move is in progress or the speed or acceleration has not been set
+*/
+bool SysStepper::move(const int32_t steps) {
+   if (_stepping || (_stepMask == 0) || (_c0 == 0) || (_cMin == 0) || (steps == 0)) {
+      return false;
+   }
+   if (_timer.armed()) {
+      _timer.disarm();
+   }
+   _direction = (steps > 0) ? 1 : -1;
+   digitalWrite(_dirPin, (steps > 0) ? HIGH : LOW);
+
+   _toPlan = (steps > 0) ? steps : -steps;
+   _toStep = _toPlan;
+   _rampStep = 0;
+   _head = 0;
+   _tail = 0;
+   plan();
+
+   // arm at the longest interval so that the AVR pre-scaler covers the whole ramp, then retune to the first step
+   uint32_t first = _ring[_tail];
+   _tail = 1;
+   _stepping = true;
+   _timer.setIntervalMicros(SYST_STEP_MAX_INTERVAL);
+   if (!_timer.arm(true) || !_timer.retuneMicros(first)) {
+      stop();
+      return false;
+   }
+   return true;
+}
+
+/*
+keep the ring of planned intervals filled: call this from loop() as often as possible during a move
+
+returns true while the motor is moving
+*/
+bool SysStepper::run(void) {
+   if (_stepping) {
+      plan();
+   } else if (_timer.armed()) {
+      _timer.disarm();                                         // the callback has made the last step
+   }
+   return _stepping;
+}
+
+// stop immediately, without decelerating
+void SysStepper::stop(void) {
+   _stepping = false;
+   _timer.disarm();
+   _toPlan = 0;
+}
@@ -0,0 +1,112 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysStepper_H_
+#define _SysStepper_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+/*
+longest step interval (usec), i.e. the speed that moves start from and stop at
+on the AVR this keeps the 16-bit timer on the 8 pre-scaler (1/2 usec resolution at 16MHz) so the interval can be
+retuned all the way up to full speed; the ramp is clamped to it at low accelerations
+*/
+#if defined(__AVR__)
+#define SYST_STEP_MAX_INTERVAL  32767UL
+#define SYST_STEP_RING          32                   // intervals planned ahead, must be a power of 2
+typedef uint16_t SysStepInterval;
+#else
+#define SYST_STEP_MAX_INTERVAL  1000000UL
+#define SYST_STEP_RING          64
+typedef uint32_t SysStepInterval;
+#endif
+
+#define SYST_STEP_PULSE         2                    // usec the step pin is held high: step drivers need 1-2 usec
+
+/*
+step/direction stepper driver on one SysTimer, with a trapezoidal acceleration profile
+
+the step intervals are computed in loop() by run() with the integer approximation of the constant acceleration ramp
+from AVR446 (c[n] = c[n-1] - 2c[n-1]/(4n+1)), and queued in a ring. The timer callback just pulses the step pin and
+retunes the timer to the next queued interval, so it takes the same few microseconds at any speed
+
+each axis needs its own timer: on the Mega, the four 16-bit timers can drive four axes
+*/
+class SysStepper {
+public:
+   SysStepper(SysTimer& timer, const uint8_t stepPin, const uint8_t dirPin) : _timer(timer), _stepPin(stepPin), _dirPin(dirPin) {}
+
+   bool     begin(void);
+   void     setMaxSpeed(const uint32_t stepsPerSec);
+   void     setAcceleration(const uint32_t stepsPerSec2);
+   bool     move(const int32_t steps);
+   bool     run(void);
+   void     stop(void);
+
+   bool moving(void) const {
+      return _stepping;
+   }
+
+   int32_t getPosition(void) const {
+      SYST_LOCK();
+      int32_t position = _position;
+      SYST_UNLOCK();
+      return position;
+   }
+
+   // number of steps that reused the previous interval because run() was not called often enough
+   uint16_t getUnderruns(void) const {
+      SYST_LOCK();
+      uint16_t underruns = _underruns;
+      SYST_UNLOCK();
+      return underruns;
+   }
+
+private:
+   void plan(void);
+
+   SysTimer&                 _timer;
+   uint8_t                   _stepPin;
+   uint8_t                   _dirPin;
+   SysPortReg                _stepReg;
+   SysPortMask               _stepMask = 0;
+
+   // ramp, in 1/256 usec
+   uint32_t                  _c0 = 0;                   // first step interval
+   uint32_t                  _cMin = 0;                 // interval at full speed
+   uint32_t                  _c = 0;                    // last planned interval
+   uint32_t                  _rampStep = 0;             // ramp index of the last planned interval, 0 before the first
+   uint32_t                  _toPlan = 0;               // intervals still to be planned for this move
+
+   volatile SysStepInterval  _ring[SYST_STEP_RING];     // volatile so each entry is stored before _head publishes it
+   volatile uint8_t          _head = 0;                 // written by run()
+   volatile uint8_t          _tail = 0;                 // written by the callback
+
+   volatile bool             _stepping = false;
+   volatile uint32_t         _toStep = 0;               // steps left in this move
+   volatile int32_t          _position = 0;
+   int8_t                    _direction = 1;
+   volatile uint16_t         _underruns = 0;
+
+   friend void _SysStepperHandler(void* arg);
+};
+
+#endif //header protect
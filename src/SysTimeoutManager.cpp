@@ -0,0 +1,354 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysTimeoutManager.h>
+
+#define NONE              0xFFFF
+#define SLOT_HEAD         0x8000                 // prev of the first timeout in a slot is SLOT_HEAD | slot
+#define MAX_CAPACITY      0x7FFF
+#define MAX_TICKS         (0x10000UL * SYST_TIMEOUT_SLOTS)  // furthest expiry a 16-bit rounds count can reach
+
+// timeout states
+#define T_FREE            0
+#define T_ARMED           1                      // in the wheel
+#define T_PENDING         2                      // expired, on the pending list
+#define T_EXPIRED         3                      // being passed to the callback
+
+#define HANDLE(index)     ((static_cast<uint32_t>(_table[index].generation) << 16) | (index))
+
+// timer callback: the wheel is turned in service(), so just count the tick
+void SYST_ISR_ATTR _SysTimeoutHandler(void* arg) {
+   SysTimeoutManager* that = static_cast<SysTimeoutManager*>(arg);
+
+   that->_ticks = that->_ticks + 1;
+}
+
+/*
+the timeout for a handle, or nullptr if it is stale
+
+timeouts that have expired but are still waiting for the callback are left out: until they have been passed
+to the callback, they can no longer be cancelled or restarted
+*/
+SysTimeout* SysTimeoutManager::entry(const SysTimeoutHandle handle) const {
+   uint16_t index = handle & 0xFFFF;
+
+   if ((index >= _capacity) || (_table[index].generation != (handle >> 16))) {
+      return nullptr;
+   }
+   uint8_t state = _table[index].state;
+   return ((state == T_ARMED) || (state == T_EXPIRED)) ? &_table[index] : nullptr;
+}
+
+/*
+the wait before the given attempt: baseMs doubled for each retry, up to maxMs, and with jitter, a random
+wait from the upper half of that
+*/
+uint32_t SysTimeoutManager::backoff(const SysBackoff& policy, const uint8_t attempt) {
+   uint32_t wait = policy.baseMs;
+
+   for (uint8_t i = 0; (i < attempt) && (wait < policy.maxMs); i++) {
+      wait = (wait > (policy.maxMs / 2)) ? policy.maxMs : (wait * 2);
+   }
+   if (policy.jitter && (wait > 1)) {
+      _random ^= _random << 13;
+      _random ^= _random >> 17;
+      _random ^= _random << 5;
+      wait = (wait / 2) + (_random % ((wait - (wait / 2)) + 1));
+   }
+   return wait;
+}
+
+/*
+the ticks from the last one the wheel was turned for to the expiry of a timeout of delayMs: the delay counts from
+the latest tick, so a timeout started before service() has caught up does not expire early
+
+returns 0 if that is further ahead than the rounds count of a timeout can reach, i.e. 0x10000 turns of the wheel
+*/
+uint32_t SysTimeoutManager::ticksFor(const uint32_t delayMs) const {
+   uint32_t ticks = (delayMs / _tickMs) + (((delayMs % _tickMs) != 0) ? 1 : 0);
+
+   noInterrupts();
+   uint32_t now = _ticks;
+   interrupts();
+
+   uint32_t lag = now - _turned;
+   ticks = (ticks > 0) ? ticks : 1;
+   return ((lag < MAX_TICKS) && (ticks <= (MAX_TICKS - lag))) ? (ticks + lag) : 0;
+}
+
+/*
+put the timeout in the wheel slot for the tick it expires on: a timeout due in t ticks goes in slot
+(_turned + t) mod SYST_TIMEOUT_SLOTS, and that slot is visited (t - 1) / SYST_TIMEOUT_SLOTS times before it is due
+*/
+void SysTimeoutManager::schedule(const uint16_t index, const uint32_t ticks) {
+   SysTimeout& timeout = _table[index];
+   uint16_t    slot = (_turned + ticks) & (SYST_TIMEOUT_SLOTS - 1);
+
+   timeout.rounds = (ticks - 1) / SYST_TIMEOUT_SLOTS;
+   timeout.state = T_ARMED;
+   timeout.prev = SLOT_HEAD | slot;
+   timeout.next = _wheel[slot];
+   if (timeout.next != NONE) {
+      _table[timeout.next].prev = index;
+   }
+   _wheel[slot] = index;
+}
+
+void SysTimeoutManager::unlink(const uint16_t index) {
+   SysTimeout& timeout = _table[index];
+
+   if (timeout.prev & SLOT_HEAD) {
+      _wheel[timeout.prev & ~SLOT_HEAD] = timeout.next;
+   } else {
+      _table[timeout.prev].next = timeout.next;
+   }
+   if (timeout.next != NONE) {
+      _table[timeout.next].prev = timeout.prev;
+   }
+}
+
+// return the timeout to the free list, with a new generation so that its handles go stale
+void SysTimeoutManager::release(const uint16_t index) {
+   SysTimeout& timeout = _table[index];
+
+   timeout.state = T_FREE;
+   if (++timeout.generation == 0) {
+      timeout.generation = 1;                               // handles are never 0
+   }
+   timeout.next = _freeList;
+   _freeList = index;
+   ++_free;
+}
+
+/*
+count ticks every tickMs msec: this is the resolution of the timeouts
+*/
+bool SysTimeoutManager::begin(const uint32_t tickMs) {
+   if (!_timer.begin() || (_table == nullptr) || (_capacity == 0) || (_capacity > MAX_CAPACITY) || (tickMs == 0)) {
+      return false;
+   }
+   _tickMs = tickMs;
+   for (uint16_t s = 0; s < SYST_TIMEOUT_SLOTS; s++) {
+      _wheel[s] = NONE;
+   }
+   for (uint16_t i = 0; i < _capacity; i++) {
+      _table[i].state = T_FREE;
+      _table[i].generation = 1;
+      _table[i].next = ((i + 1) < _capacity) ? (i + 1) : NONE;
+   }
+   _freeList = 0;
+   _free = _capacity;
+   _pending = NONE;
+   _pendingTail = NONE;
+   _ticks = 0;
+   _turned = 0;
+   _timer.attachInterrupt(_SysTimeoutHandler, this);
+   _timer.setInterval(tickMs);
+   return _timer.arm(true);
+}
+
+void SysTimeoutManager::end(void) {
+   _timer.disarm();
+}
+
+/*
+start a timeout for the first attempt of the policy, which must stay in scope while the timeout is in use
+
+returns SYST_TIMEOUT_INVALID if the table is full or the wait is too long for the wheel (see ticksFor())
+*/
+SysTimeoutHandle SysTimeoutManager::start(const SysBackoff& policy, void* context) {
+   if (_freeList == NONE) {
+      return SYST_TIMEOUT_INVALID;
+   }
+   uint32_t ticks = ticksFor(backoff(policy, 0));
+
+   if (ticks == 0) {
+      return SYST_TIMEOUT_INVALID;
+   }
+   uint16_t    index = _freeList;
+   SysTimeout& timeout = _table[index];
+
+   _freeList = timeout.next;
+   --_free;
+   timeout.policy = &policy;
+   timeout.context = context;
+   timeout.attempt = 0;
+   schedule(index, ticks);
+   return HANDLE(index);
+}
+
+/*
+stop the timeout and free it. The handle is stale from now on
+
+returns false if the handle is already stale, or the timeout has expired and is waiting to be passed to the callback
+*/
+bool SysTimeoutManager::cancel(const SysTimeoutHandle handle) {
+   SysTimeout* timeout = entry(handle);
+
+   if (timeout == nullptr) {
+      return false;
+   }
+   uint16_t index = handle & 0xFFFF;
+   if (timeout->state == T_ARMED) {
+      unlink(index);
+   }
+   release(index);
+   return true;
+}
+
+/*
+start the timeout again from the first attempt, e.g. when there has been activity on a connection
+
+returns false if the handle is stale or the wait is too long for the wheel, and the timeout is left as it was
+*/
+bool SysTimeoutManager::restart(const SysTimeoutHandle handle) {
+   SysTimeout* timeout = entry(handle);
+
+   if (timeout == nullptr) {
+      return false;
+   }
+   uint32_t ticks = ticksFor(backoff(*timeout->policy, 0));
+
+   if (ticks == 0) {
+      return false;
+   }
+   uint16_t index = handle & 0xFFFF;
+   if (timeout->state == T_ARMED) {
+      unlink(index);
+   }
+   timeout->attempt = 0;
+   schedule(index, ticks);
+   return true;
+}
+
+/*
+start the timeout again for the next retry, with the backoff applied: call this from the expiry callback to
+keep the timeout (and its handle)
+
+returns false if the handle is stale, the policy's retries have been used up or the wait is too long for the
+wheel, and the timeout is left as it was
+*/
+bool SysTimeoutManager::retry(const SysTimeoutHandle handle) {
+   SysTimeout* timeout = entry(handle);
+
+   if ((timeout == nullptr) || (timeout->attempt >= timeout->policy->maxRetries)) {
+      return false;
+   }
+   uint32_t ticks = ticksFor(backoff(*timeout->policy, timeout->attempt + 1));
+
+   if (ticks == 0) {
+      return false;
+   }
+   uint16_t index = handle & 0xFFFF;
+   if (timeout->state == T_ARMED) {
+      unlink(index);
+   }
+   ++timeout->attempt;
+   schedule(index, ticks);
+   return true;
+}
+
+/*
+pass the pending timeouts to the callback, up to SYST_TIMEOUT_BATCH at a time
+
+the callback may retry, restart or cancel any of them (or any other timeout); those it leaves alone are freed
+when it returns
+*/
+void SysTimeoutManager::deliver(void) {
+   while (_pending != NONE) {
+      uint8_t count = 0;
+
+      while ((_pending != NONE) && (count < SYST_TIMEOUT_BATCH)) {
+         uint16_t index = _pending;
+         _pending = _table[index].next;
+         _table[index].state = T_EXPIRED;
+         _batch[count++] = HANDLE(index);
+      }
+      if (_pending == NONE) {
+         _pendingTail = NONE;
+      }
+      if (_callback != nullptr) {
+         (*_callback)(_batch, count, _callbackArg);
+      }
+      for (uint8_t i = 0; i < count; i++) {
+         uint16_t index = _batch[i] & 0xFFFF;
+         if ((_table[index].state == T_EXPIRED) && (_table[index].generation == (_batch[i] >> 16))) {
+            release(index);
+         }
+      }
+   }
+}
+
+/*
+turn the wheel for the ticks since the last call and pass the timeouts that have expired to the callback:
+call this from loop()
+
+each slot's list is detached before it is walked, so the timeouts still to come can be put straight back, and
+the callback is not called until the walk is over, so it cannot change a list that is being walked
+
+returns the number of timeouts that expired
+*/
+uint16_t SysTimeoutManager::service(void) {
+   uint16_t expired = 0;
+
+   if (_servicing) {
+      return 0;                                             // called from the callback
+   }
+   _servicing = true;
+
+   noInterrupts();
+   uint32_t now = _ticks;
+   interrupts();
+
+   while (_turned != now) {
+      uint16_t slot = (++_turned) & (SYST_TIMEOUT_SLOTS - 1);
+      uint16_t index = _wheel[slot];
+
+      _wheel[slot] = NONE;
+      while (index != NONE) {
+         SysTimeout& timeout = _table[index];
+         uint16_t    next = timeout.next;
+
+         if (timeout.rounds > 0) {
+            --timeout.rounds;
+            timeout.prev = SLOT_HEAD | slot;
+            timeout.next = _wheel[slot];
+            if (timeout.next != NONE) {
+               _table[timeout.next].prev = index;
+            }
+            _wheel[slot] = index;
+         } else {
+            timeout.state = T_PENDING;
+            timeout.next = NONE;
+            if (_pendingTail == NONE) {
+               _pending = index;
+            } else {
+               _table[_pendingTail].next = index;
+            }
+            _pendingTail = index;
+            ++expired;
+         }
+         index = next;
+      }
+      deliver();
+   }
+   _servicing = false;
+   return expired;
+}
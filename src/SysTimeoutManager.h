@@ -0,0 +1,145 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysTimeoutManager_H_
+#define _SysTimeoutManager_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+#if defined(__AVR__)
+#define SYST_TIMEOUT_SLOTS     32                // timing wheel slots, must be a power of 2
+#else
+#define SYST_TIMEOUT_SLOTS     256
+#endif
+#define SYST_TIMEOUT_BATCH     16                // most expired timeouts passed to one callback
+#define SYST_TIMEOUT_INVALID   0UL               // never returned as a valid handle
+
+/*
+handles are the table index in the low 16 bits and the entry's generation in the high 16 bits: the generation
+changes every time an entry is freed, so a handle to a timeout that has expired or been cancelled just fails,
+even if the entry has since been reused
+*/
+typedef uint32_t SysTimeoutHandle;
+typedef void (*TimeoutBatchFunc)(const SysTimeoutHandle* expired, const uint8_t count, void* arg);
+
+/*
+retry policy: each retry waits twice as long as the one before, from baseMs up to maxMs (set maxMs to baseMs
+for a fixed timeout). With jitter, each wait is chosen at random from the upper half of this range, so that
+retries started together do not stay together
+*/
+struct SysBackoff {
+   uint32_t baseMs;
+   uint32_t maxMs;
+   uint8_t  maxRetries;
+   bool     jitter;
+};
+
+// one timeout: 14 bytes on the AVR
+struct SysTimeout {
+   uint16_t          next;                       // wheel slot list, or free list
+   uint16_t          prev;
+   uint16_t          generation;
+   uint16_t          rounds;                     // further turns of the wheel before it expires
+   uint8_t           attempt;                    // retries so far
+   uint8_t           state;
+   const SysBackoff* policy;
+   void*             context;
+};
+
+/*
+many timeouts with retry/backoff, on one SysTimer (up to 32767 of them)
+
+the timeouts are kept in a hashed timing wheel: each slot holds a doubly linked list of the timeouts that expire
+on a tick that maps to it, so starting, cancelling and restarting a timeout are all O(1), and each tick only visits
+one slot. The timer callback just counts ticks; service(), called from loop(), turns the wheel and passes the
+timeouts that have expired to your callback in batches, so it can do anything loop() can
+
+the wheel lists are linked by 16-bit index into the sketch's SysTimeout array rather than by pointer, which keeps
+each entry small and limits the table to 32767 entries
+*/
+class SysTimeoutManager {
+public:
+   SysTimeoutManager(SysTimer& timer, SysTimeout* table, const uint16_t capacity) : _timer(timer), _table(table), _capacity(capacity) {}
+
+   bool             begin(const uint32_t tickMs = 10);
+   void             end(void);
+   SysTimeoutHandle start(const SysBackoff& policy, void* context = nullptr);
+   bool             cancel(const SysTimeoutHandle handle);
+   bool             restart(const SysTimeoutHandle handle);
+   bool             retry(const SysTimeoutHandle handle);
+   uint16_t         service(void);
+
+   void onExpire(const TimeoutBatchFunc callback, void* callbackArg = nullptr) {
+      _callback = callback;
+      _callbackArg = callbackArg;
+   }
+
+   // true if the timeout is running, or is being passed to your callback
+   bool active(const SysTimeoutHandle handle) const {
+      return entry(handle) != nullptr;
+   }
+
+   void* getContext(const SysTimeoutHandle handle) const {
+      SysTimeout* timeout = entry(handle);
+      return (timeout != nullptr) ? timeout->context : nullptr;
+   }
+
+   uint8_t getAttempt(const SysTimeoutHandle handle) const {
+      SysTimeout* timeout = entry(handle);
+      return (timeout != nullptr) ? timeout->attempt : 0;
+   }
+
+   uint16_t getFree(void) const {
+      return _free;
+   }
+
+private:
+   SysTimeout* entry(const SysTimeoutHandle handle) const;
+   uint32_t    ticksFor(const uint32_t delayMs) const;
+   void        schedule(const uint16_t index, const uint32_t ticks);
+   void        unlink(const uint16_t index);
+   void        release(const uint16_t index);
+   void        deliver(void);
+   uint32_t    backoff(const SysBackoff& policy, const uint8_t attempt);
+
+   SysTimer&           _timer;
+   SysTimeout*         _table;
+   uint16_t            _capacity;
+   uint32_t            _tickMs = 10;
+
+   uint16_t            _wheel[SYST_TIMEOUT_SLOTS];
+   uint16_t            _freeList = 0;
+   uint16_t            _free = 0;
+   volatile uint32_t   _ticks = 0;                   // counted by the timer callback
+   uint32_t            _turned = 0;                  // ticks the wheel has been turned for
+   uint32_t            _random = 2463534242UL;       // xorshift32 state for jitter
+
+   TimeoutBatchFunc    _callback = nullptr;
+   void*               _callbackArg = nullptr;
+   SysTimeoutHandle    _batch[SYST_TIMEOUT_BATCH];
+   uint16_t            _pending = 0;                 // expired timeouts waiting to be passed to the callback, oldest first
+   uint16_t            _pendingTail = 0;
+   bool                _servicing = false;
+
+   friend void _SysTimeoutHandler(void* arg);
+};
+
+#endif //header protect
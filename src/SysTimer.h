@@ -28,10 +28,26 @@ To view a copy of this license, visit https://creativecommons.org/licenses/by-sa
 #endif
 
 enum class Platform:uint8_t { T_ESP, T_AVR, T_SAM };
+enum class CaptureEdge:uint8_t { C_RISING, C_FALLING, C_BOTH };
 
 typedef void (*CallbackFunc)(void);
 typedef void (*CallbackArg)(void*);
 
+/*
+ critical section for the status functions: the interrupt state is saved and restored rather than enabled on exit,
+ since these may also be called from a timer callback, i.e. in the ISR
+*/
+#if defined(ESP8266)
+   #define SYST_LOCK()     uint32_t _systSavedPS = xt_rsil(15)
+   #define SYST_UNLOCK()   xt_wsr_ps(_systSavedPS)
+#elif defined(__SAM3X8E__)
+   #define SYST_LOCK()     uint32_t _systSavedPRIMASK = __get_PRIMASK(); __disable_irq()
+   #define SYST_UNLOCK()   __set_PRIMASK(_systSavedPRIMASK)
+#elif defined(__AVR__)
+   #define SYST_LOCK()     uint8_t _systSavedSREG = SREG; cli()
+   #define SYST_UNLOCK()   SREG = _systSavedSREG
+#endif
+
 // base class, not directly used
 class SysTimerBase {
 public:
@@ -40,12 +56,25 @@ public:
 
    virtual bool begin(void) const { return _valid; }
 
-   void setInterval(uint32_t interval) { _interval = interval; }
+   void setInterval(uint32_t interval) {
+      _interval = interval;
+      _intervalUs = 0;
+   }
+
+   // platforms without sub-millisecond resolution round this up to the next whole millisecond
+   void setIntervalMicros(uint32_t interval) {
+      _intervalUs = interval;
+      _interval = (interval + 999) / 1000;
+   }
 
    uint32_t getInterval(void) const {
       return _interval;
    }
 
+   uint32_t getIntervalMicros(void) const {
+      return (_intervalUs > 0) ? _intervalUs : _interval * 1000;
+   }
+
    bool armed(void) const {
       return _armed;
    }
@@ -54,20 +83,68 @@ public:
       return _repeating;
    }
 
+   // true if retuneMicros() sets the interval to the microsecond, so a callback can step the timer through exact intervals
+   bool canRetune(void) const {
+      return _retunable;
+   }
+
+   // number of times the callback has been called since the timer was declared
+   uint32_t getFireCount(void) const {
+      SYST_LOCK();
+      uint32_t count = _fireCount;
+      SYST_UNLOCK();
+      return count;
+   }
+
    Platform getPlatform(void) const {
       return _platform;
    }
 
+   // usec since the start of the current period, read from the hardware counter where there is one (0 if not armed)
+   uint32_t elapsedInPeriod(void) const {
+      uint32_t elapsed, period;
+      return readPosition(elapsed, period) ? elapsed : 0;
+   }
+
+   // fraction of the current period that has elapsed, from 0 to 65535 (0 if not armed)
+   uint16_t phase(void) const {
+      uint32_t elapsed, period;
+      if (!readPosition(elapsed, period) || (period == 0)) {
+         return 0;
+      }
+      // scale down so (elapsed << 16) fits in 32 bits, which avoids 64-bit division on the AVR
+      while (period > 0xFFFF) {
+         period >>= 1;
+         elapsed >>= 1;
+      }
+      uint32_t fraction = (elapsed << 16) / period;
+      return (fraction > 0xFFFF) ? 0xFFFF : static_cast<uint16_t>(fraction);
+   }
+
 protected:
+   /*
+    read the position within the current period, in usec, atomically with respect to the timer interrupt
+    returns false if the timer is not running
+   */
+   virtual bool readPosition(uint32_t& elapsed, uint32_t& period) const {
+      (void)elapsed;
+      (void)period;
+      return false;
+   }
+
    Platform      _platform;
    bool          _valid = false;                      // true if this is a valid (enabled) timer
+   bool          _retunable = false;                  // retuneMicros() has usec resolution on this timer
    volatile bool _armed = false;                      // true when timer is active
    static int8_t _index;                              // counter for instantiated objects, initialized in SysTimer_SAM.cpp
    uint32_t      _interval = 0;                       // msec interval for timer
+   uint32_t      _intervalUs = 0;                     // usec interval for timer, 0 if set in msec
    volatile bool _repeating = false;                  // true if the timer continues until stopped
    volatile bool _oneshot = false;                    // control flag for one-shot events
    CallbackArg   _callback = nullptr;                 // timer interrupt user callback function
    void*         _callbackArg = nullptr;              // argument for aforementioned callback function
+   volatile uint32_t _fireCount = 0;                  // number of callbacks, updated by the shim ISR
+   volatile bool _inCallback = false;                 // the shim ISR is running the callback, so must not call it again
 };
 
 #if defined(ESP8266)
@@ -75,8 +152,39 @@ protected:
 extern "C" {
    #include <user_interface.h>
 }
-#define SYST_MAX_TIMERS  -1                            // -1 indicates no inherent limit
-#define SysTimer ESPTimer
+#define SYST_ESP_HW_TIMERS  8                          // ESPHWTimer objects multiplexed onto the FRC1 hardware timer
+
+/*
+ By default SysTimer uses the SDK software timers (os_timer), which have a 5 msec minimum interval and run the callback
+ from the SDK task queue. Declare USING_ESP_HW_TIMER before including this library to use the FRC1 hardware timer instead,
+ which supports microsecond intervals and calls the callback from a real interrupt
+*/
+#ifdef USING_ESP_HW_TIMER
+   #define SYST_MAX_TIMERS  SYST_ESP_HW_TIMERS
+   #define SysTimer ESPHWTimer
+#else
+   #define SYST_MAX_TIMERS  -1                         // -1 indicates no inherent limit
+   #define SysTimer ESPTimer
+#endif
+
+/*
+ Each ESPTimer normally owns an SDK os_timer, so every arm inserts into the SDK timer list and every expiry is a separate SDK task.
+ Declare USING_ESP_TIMER_MUX before including this library to have all ESPTimer objects share a single os_timer instead:
+ armed timers are kept in a min-heap ordered by deadline, and the shared os_timer is only re-armed when the earliest deadline changes.
+ os_timer callbacks and loop() run in the same (non-preemptive) SDK context, and arm() must be called from there.
+ disarm() does not touch the heap: it just clears the timer's flags, and the timer is dropped from the heap when it reaches the top
+ (or when the heap is full). The places where the multiplexer tests those flags and acts on them run with interrupts disabled,
+ so disarm() may also be called from an interrupt handler: the timer is not called again unless its callback was already being
+ started. A timer left in the heap is removed by its destructor.
+*/
+#define SYST_ESP_MUX_TIMERS  256                       // maximum number of ESPTimer objects armed at once in multiplexed mode
+
+class ESPTimer;
+
+extern bool  _ESPMuxArm(ESPTimer* that);
+extern void  _ESPMuxRemove(int16_t pos);
+extern void  _ESPMuxRetune(ESPTimer* that, const uint32_t msec);
+extern void  _ESPCommonHandler(void* arg);
 
 // ESP8266 class
 class ESPTimer : public SysTimerBase {
@@ -84,36 +192,232 @@ public:
    ESPTimer() { 
       _platform = Platform::T_ESP;
       _valid = true;
+      // the SDK calls our shim with this object as the argument, so we can track the timer state and call the user's callback
+      os_timer_setfn(&_timer, static_cast<ETSTimerFunc*>(_ESPCommonHandler), this);
+   }
+
+   // neither the SDK timer list nor the multiplexer heap may keep a pointer to a timer that has gone
+   ~ESPTimer() {
+#ifdef USING_ESP_TIMER_MUX
+      SYST_LOCK();
+      _armed = false;
+      if (_heapPos >= 0) {
+         _ESPMuxRemove(_heapPos);
+      }
+      SYST_UNLOCK();
+#else
+      os_timer_disarm(&_timer);
+#endif
    }
 
    bool begin(void) const override { return true; }
 
    bool attachInterrupt(CallbackArg isr, void* callbackArg = nullptr) {
       _callback = isr;
-      os_timer_setfn(&_timer, static_cast<ETSTimerFunc*>(isr), callbackArg);
+      _callbackArg = callbackArg;
       return true;
    }
 
    bool arm(const bool repeat)  {
       if ((_callback != nullptr) && (_interval > 0)) {
          _interval = (_interval >= 5) ? _interval : 5;
-         os_timer_arm(&_timer, _interval, repeat);
          _repeating = repeat;
-         _armed = repeat ? true : false;             // we have no way to clear the flag after the interrupt actually happens, so must do it here
+         _oneshot = !repeat;                         // the shim clears this and _armed after the one-shot callback
+         _periodStart = micros();
+#ifdef USING_ESP_TIMER_MUX
+         _armed = true;                              // set first, as the multiplexer drops disarmed timers from its heap
+         if (!_ESPMuxArm(this)) {
+            _armed = false;                          // not _armed = _ESPMuxArm(), which would undo a disarm() from an interrupt
+         }
+#else
+         os_timer_arm(&_timer, _interval, repeat);
+         _armed = true;
+#endif
       } else {
          _armed = false;
       }
       return _armed;
    }
 
+   /*
+    change the interval of an armed timer, taking effect from the current callback, without disarming it
+    os_timer only has msec resolution, so the interval is rounded up to whole msec (minimum 5)
+   */
+   bool retuneMicros(const uint32_t usec) {
+      if (!_armed) {
+         return false;
+      }
+      uint32_t msec = (usec + 999) / 1000;
+      msec = (msec >= 5) ? msec : 5;
+#ifdef USING_ESP_TIMER_MUX
+      _ESPMuxRetune(this, msec);
+#else
+      _interval = msec;
+      os_timer_arm(&_timer, _interval, _repeating);
+#endif
+      _intervalUs = usec;
+      return true;
+   }
+
    bool disarm(void)  {
+#ifndef USING_ESP_TIMER_MUX
       os_timer_disarm(&_timer);
+#endif
+      _repeating = false;
+      _oneshot = false;
       _armed = false;
       return true;
    }
 
+protected:
+   // os_timer has no readable counter, so this is measured from the last callback
+   bool readPosition(uint32_t& elapsed, uint32_t& period) const override {
+      if (!_armed) {
+         return false;
+      }
+      period = _interval * 1000;
+      elapsed = micros() - _periodStart;
+      elapsed = (elapsed < period) ? elapsed : period;
+      return true;
+   }
+
 private:
    os_timer_t    _timer;
+   volatile uint32_t _periodStart = 0;               // micros() value at the start of the current period
+   uint32_t      _deadline = 0;                      // millis() value at which the next callback is due (multiplexed mode)
+   int16_t       _heapPos = -1;                      // position in the multiplexer heap, -1 if not scheduled
+
+   // allow the shim and multiplexer to access the object private parts
+   friend void  _ESPCommonHandler(void* arg);
+   friend bool  _ESPMuxArm(ESPTimer* that);
+   friend void  _ESPMuxCollect(void);
+   friend void  _ESPMuxRetune(ESPTimer* that, const uint32_t msec);
+   friend void  _ESPMuxHandler(void* arg);
+   friend void  _ESPMuxSiftUp(int16_t pos);
+   friend void  _ESPMuxSiftDown(int16_t pos);
+   friend void  _ESPMuxRemove(int16_t pos);
+   friend void  _ESPMuxPlace(ESPTimer* that, const int16_t pos);
+   friend void  _ESPMuxReschedule(const uint32_t now);
+};
+
+/*
+ ESP8266 FRC1 hardware timer class
+
+ There is only one FRC1 timer, so it is shared by all ESPHWTimer objects: each object keeps an absolute deadline (in usec)
+ and the FRC1 interrupt handler fires every object that is due, then reloads FRC1 with the time to the earliest remaining deadline.
+ FRC1 is clocked at 80MHz / 16 = 5 ticks per usec and has a 23-bit counter, so longer intervals are covered in several reloads.
+
+ Note that FRC1 (timer1) is also used by the ESP8266 core for analogWrite, tone and Servo
+*/
+#define SYST_ESP_HW_MIN_INTERVAL     10              // usec, shortest interval we will load into FRC1
+#define SYST_ESP_HW_SPIN             5               // usec, a deadline this close after a pass is waited for rather than reloaded
+#define SYST_ESP_HW_MAX_INTERVAL     1677000         // usec, longest interval that fits in the 23-bit FRC1 counter at 5 ticks/usec
+#define SYST_ESP_HW_TICKS_PER_USEC   5               // 80MHz APB clock with TIM_DIV16 prescaler
+
+class ESPHWTimer;
+extern ESPHWTimer* _ESPHWTimerTable[];
+
+extern void  startHWTimer(const uint8_t timerNum, const uint32_t usec);
+extern void  stopHWTimer(const uint8_t timerNum);
+extern void  retuneHWTimer(const uint8_t timerNum, const uint32_t usec);
+
+class ESPHWTimer : public SysTimerBase {
+public:
+   ESPHWTimer() {
+      if (_index + 1 <= SYST_ESP_HW_TIMERS) {
+         _platform = Platform::T_ESP;
+         _valid = true;
+         _retunable = true;
+         _current = _index;
+         ++_index;
+         // save address of this object so we can access state vars from the FRC1 ISR
+         _ESPHWTimerTable[_current] = this;
+      } else {
+         // instantiated but not valid: a zombie timer - user must call begin method to validate
+         _valid = false;
+      }
+   }
+
+   // the callback is called from the FRC1 ISR, so it must be declared ICACHE_RAM_ATTR
+   bool attachInterrupt(const CallbackArg isr, void* callbackArg = nullptr) {
+      if (_valid) {
+         _callback = isr;
+         _callbackArg = callbackArg;
+         return true;
+      } else {
+         return false;
+      }
+   }
+
+   bool arm(const bool repeat) {
+      if (_valid && (_callback != nullptr) && (_interval > 0)) {
+         if (repeat) {
+            _repeating = true;
+            _oneshot = false;
+         } else {
+            _repeating = false;
+            _oneshot = true;                     // will be flipped once we get the first callback
+         }
+         // sets _armed together with the new deadline, so the FRC1 ISR cannot see one without the other
+         startHWTimer(_current, getIntervalMicros());
+      } else {
+         _armed = false;
+      }
+      return _armed;
+   }
+
+   /*
+    change the interval of an armed timer without disarming it
+    when called from the callback, the next callback is due one new interval after the current one was due
+   */
+   bool retuneMicros(const uint32_t usec) {
+      if (_valid && _armed) {
+         retuneHWTimer(_current, usec);
+         _intervalUs = usec;
+         _interval = (usec + 999) / 1000;
+         return true;
+      } else {
+         return false;
+      }
+   }
+
+   bool disarm(void) {
+      if (_valid) {
+         _repeating = false;
+         _oneshot = false;
+         _armed = false;
+         stopHWTimer(_current);
+         return true;
+      } else {
+         return false;
+      }
+   }
+
+protected:
+   bool readPosition(uint32_t& elapsed, uint32_t& period) const override {
+      SYST_LOCK();
+      bool running = _armed;
+      uint32_t remaining = _deadline - micros();
+      period = _period;
+      SYST_UNLOCK();
+      if (!running) {
+         return false;
+      }
+      elapsed = (static_cast<int32_t>(remaining) > 0) ? ((remaining < period) ? period - remaining : 0) : period;
+      return true;
+   }
+
+private:
+   int8_t            _current = -1;              // indexes the current timer
+   uint32_t          _period = 0;                // usec between callbacks
+   volatile uint32_t _deadline = 0;              // micros() value at which the next callback is due
+
+   // allow the multiplexer to access the object private parts
+   friend void startHWTimer(const uint8_t timerNum, const uint32_t usec);
+   friend void retuneHWTimer(const uint8_t timerNum, const uint32_t usec);
+   friend void _ESPHWCommonHandler(void);
+   friend uint32_t _ESPHWFire(uint32_t now);
+   friend void _ESPHWSchedule(const uint32_t now);
 };
 
 #elif defined(__SAM3X8E__)
@@ -132,42 +436,39 @@ private:
  A more elegant way would be to use a Lambda function or std::function wrappers but this would require library modifications.
 */
 
+/*
+ timers are numbered by their DueTimer timer number (0:8), and the Servo library uses timers 2, 3, 4 and 5
+*/
+#define SYST_SAM_SLOTS        9                    // timers pre-instantiated in DueTimer library
+
 #ifndef USING_SERVO_LIB
-   #define SYST_MAX_TIMERS    9                    // timers pre-instantiated in DueTimer library
-
-   static void _isrSAM0 (void);
-   static void _isrSAM1 (void);
-   static void _isrSAM2 (void);
-   static void _isrSAM3 (void);
-   static void _isrSAM4 (void);
-   static void _isrSAM5 (void);
-   static void _isrSAM6 (void);
-   static void _isrSAM7 (void);
-   static void _isrSAM8 (void);
+   #define SYST_MAX_TIMERS    9
+   #define SYST_SAM_RESERVED  0
 #else
    #define SYST_MAX_TIMERS    5
-
-   static void _isrSAM0 (void);                 // refers to Timer, not Timer0 in DueTimer.cpp, but 0 used here for consistency
-   static void _isrSAM1 (void);
-   static void _isrSAM6 (void);
-   static void _isrSAM7 (void);
-   static void _isrSAM8 (void);
+   #define SYST_SAM_RESERVED  (bit(2) | bit(3) | bit(4) | bit(5))
 #endif
 
 class SAMTimer;
 
 extern SAMTimer*    _SAMTimerTable[];
 extern CallbackFunc _SAMCallbackTable[];
+extern DueTimer*    _SAMDueTimers[];
+
+extern int8_t       allocTimer(const uint16_t reserved);
+extern void         setStopOnCompare(const uint8_t timerNum, const bool stop);
+extern void         timerPosition(const uint8_t timerNum, uint32_t& elapsed, uint32_t& period);
+extern bool         retuneTimer(const uint8_t timerNum, const uint32_t usec);
 
 // SAM (Due) class
 class SAMTimer : public SysTimerBase {
 public:
    SAMTimer() { 
-      if (_index + 1 <= SYST_MAX_TIMERS) {
+      _current = allocTimer(SYST_SAM_RESERVED);
+      if (_current >= 0) {
          _platform = Platform::T_SAM;
          _valid = true;
-         _current = _index;
-         ++_index;
+         _retunable = true;
          // save address of this object so we can access state vars from our ISR
          _SAMTimerTable[_current] = this;
       } else {
@@ -184,7 +485,7 @@ public:
          */
          _callback = isr;
          _callbackArg = callbackArg;
-         _DueTimers[_current]->attachInterrupt(_SAMCallbackTable[_current]);
+         _SAMDueTimers[_current]->attachInterrupt(_SAMCallbackTable[_current]);
          return true;
       } else {
          return false;
@@ -200,7 +501,9 @@ public:
             _repeating = false;
             _oneshot = true;                     // will be flipped once we get the first callback
          }
-         _DueTimers[_current]->start(static_cast<double>(_interval * 1000));          // msec to usec
+         _SAMDueTimers[_current]->start(static_cast<double>(getIntervalMicros()));
+         // for one-shots, the TC stops itself on the RC compare, so the ISR does not need to stop it
+         setStopOnCompare(_current, !repeat);
          _armed = true;
       } else {
          _armed = false;
@@ -208,10 +511,24 @@ public:
       return _armed;
    }
 
+   /*
+    change the interval of an armed timer without disarming it, using the TC clock DueTimer selected when it was armed
+    when called from the callback, the next callback is due one new interval after the current one
+   */
+   bool retuneMicros(const uint32_t usec) {
+      if (_valid && _armed && retuneTimer(_current, usec)) {
+         _intervalUs = usec;
+         _interval = (usec + 999) / 1000;
+         return true;
+      } else {
+         return false;
+      }
+   }
+
    // stop the timer, but leave the state vars intact, so you just need to rearm it to restart
    bool disarm(void) {
       if (_valid) {
-         _DueTimers[_current]->stop();
+         _SAMDueTimers[_current]->stop();
          _repeating = false;
          _oneshot = false;
          _armed = false;
@@ -221,35 +538,35 @@ public:
       }
    }
 
+protected:
+   bool readPosition(uint32_t& elapsed, uint32_t& period) const override {
+      if (_valid && _armed) {
+         timerPosition(_current, elapsed, period);
+         return true;
+      } else {
+         return false;
+      }
+   }
+
 private:
    int8_t      _current = -1;              // indexes the current timer
-   // table of the pre-allocated timer objects in the DueTimer library, which we use directly
-#ifndef USING_SERVO_LIB
-   DueTimer* _DueTimers[SYST_MAX_TIMERS] = { &Timer0, &Timer1, &Timer2, &Timer3, &Timer4, &Timer5, &Timer6, &Timer7 };
 
    // allow shim ISR to access the object private parts
    friend  void _SAMCommonHandler(SAMTimer* that);
-   friend  void _isrSAM0(void);
-   friend  void _isrSAM1(void);
-   friend  void _isrSAM2(void);
-   friend  void _isrSAM3(void);
-   friend  void _isrSAM4(void);
-   friend  void _isrSAM5(void);
-   friend  void _isrSAM6(void);
-   friend  void _isrSAM7(void);
-   friend  void _isrSAM8(void);
-#else
-   DueTimer* _DueTimers[MAX_TIMERS] = { &Timer, &Timer1, &Timer6, &Timer7 };
-   friend  void _SAMCommonHandler(SAMTimer* that);
-   friend  void _isrSAM0(void);
-   friend  void _isrSAM1(void);
-   friend  void _isrSAM6(void);
-   friend  void _isrSAM7(void);
-   friend  void _isrSAM8(void);
-#endif
 };
 
+/*
+ Input capture: the TC channel latches its counter into RA on each edge of its TIOA input, and the capture ISR copies
+ this timestamp into a ring buffer that loop() reads in batches. Only the timers with a TIOA pin broken out on the Due can be used:
+
+   timer 0: pin 2    timer 6: pin 5    timer 7: pin 3    timer 8: pin 11
 
+ The counter runs at MCK/2 (42MHz) and is 32 bits wide, so timestamps wrap every 102 seconds.
+*/
+#define SYST_CAPTURE_SLOTS          (bit(0) | bit(6) | bit(7) | bit(8))
+#define SYST_CAPTURE_RESERVED       (static_cast<uint16_t>(~SYST_CAPTURE_SLOTS) | SYST_SAM_RESERVED)
+#define SYST_CAPTURE_BUFFER         128                                    // timestamps, must be a power of 2 no larger than 128
+#define SYST_CAPTURE_TICKS_PER_USEC (VARIANT_MCK / 2000000UL)
 #elif defined(__AVR__)
 #include <avr/io.h>
 
@@ -257,11 +574,13 @@ private:
 
 /*
 AVR timer implementation for ATMega 8/16-bit timers:
-Uno (ATmega168/328) :       timer 1
-Pro Micro (ATmega16/32U4):  timer 1, 3
-Mega (ATMega1280/2560) :    timer 1, 3, 4, 5
+Uno (ATmega168/328) :       timer 1, timer 2, timer 0 compare B
+Pro Micro (ATmega16/32U4):  timer 1, 3, timer 0 compare B
+Mega (ATMega1280/2560) :    timer 1, 3, 4, 5, timer 2, timer 0 compare B
 
-Note that the Servo.h library uses Timer 1, so we address that with the USING_SERVO_LIB define as we did with the Due
+Note that the Servo.h library uses Timer 1, so we address that with the USING_SERVO_LIB define as we did with the Due.
+Timer 2 and Timer 0 compare B are also used by tone() and by other libraries, so they are only used if the sketch declares
+USING_AVR_TIMER2 or USING_AVR_TIMER0B respectively.
 
 Reference: https://arduinodiy.wordpress.com/2012/02/28/timer-interrupts/
 
@@ -273,6 +592,11 @@ Basic strategy:
 5. The ISR for the overflow timer fires at the end of the interval, and we take the necessary actions in the ISR
 e.g. countine counting, stop the timer, etc.
 
+The 8-bit timers cannot reach useful intervals from the counter alone, so they interrupt at a fixed base rate instead
+and the ISR counts interrupts (a software post-scaler) until the interval has elapsed:
+- Timer 2 runs in CTC mode with a 64 pre-scaler, interrupting every 1 msec
+- Timer 0 is left untouched as the millis() timer, and we only enable its compare B interrupt, which fires once per
+  256-tick overflow cycle (every 1.024 msec on a 16MHz processor)
 */
 
 // macros for register pre-defined symbols  - see iomx8.h for Arduino, iomxx0_1.h for Arduino Mega
@@ -284,41 +608,136 @@ e.g. countine counting, stop the timer, etc.
 #define MAX_INTERVAL          ((65535.0 * 1024.0)/(double)F_CPU)          // floating representation of longest timer interval with 16-bit counter and 1024 pre-scaler
 
 
-// set number of available 16-bit timers
+// set number of 16-bit timers
 #if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
-   #define SYST_MAX_TIMERS    4               // TImers 1, 3, 4, 5
-#elif defined(__AVR_ATmega32u4__) || defined(ARDUINO_AVR_PROMICRO) || defined(__AVR_ATmega16u4__)
-   #define SYST_MAX_TIMERS    2               // Timers 1, 3
-#elif !defined(USING_SERVO_LIB)
-   #define SYST_MAX_TIMERS    1
-#else 
-   #define SYST_MAX_TIMERS    0               // Timer 1 exists but cannot be used
+   #define SYST_AVR_TIMER16    4              // Timers 1, 3, 4, 5
+#elif defined(__AVR_ATmega32U4__) || defined(__AVR_ATmega32u4__) || defined(ARDUINO_AVR_PROMICRO) || defined(__AVR_ATmega16u4__)
+   #define SYST_AVR_TIMER16    2              // Timers 1, 3
+#else
+   #define SYST_AVR_TIMER16    1              // Timer 1
+#endif
+
+/*
+timer "slots" are numbered in a fixed order: the 16-bit timers, then Timer 2 (if the processor has one), then Timer 0 compare B
+this numbering is the same in every compilation unit, regardless of which timers the sketch has reserved
+*/
+#if defined(TCCR2A)
+   #define SYST_AVR_SLOT_TIMER2     SYST_AVR_TIMER16
+   #define SYST_AVR_SLOT_TIMER0B    (SYST_AVR_TIMER16 + 1)
+#else
+   #define SYST_AVR_SLOT_TIMER0B    SYST_AVR_TIMER16
+#endif
+#define SYST_AVR_SLOTS              (SYST_AVR_SLOT_TIMER0B + 1)
+
+// slots reserved for other libraries
+#if defined(USING_SERVO_LIB) && (SYST_AVR_TIMER16 == 1)
+   #define SYST_AVR_SERVO_RESERVED  1               // Timer 1 exists but cannot be used
+   #define SYST_AVR_SERVO_MASK      _BV(0)
+#else
+   #define SYST_AVR_SERVO_RESERVED  0
+   #define SYST_AVR_SERVO_MASK      0
 #endif
 
+// the 8-bit slots are reserved unless the sketch asks for them
+#if defined(SYST_AVR_SLOT_TIMER2) && !defined(USING_AVR_TIMER2)
+   #define SYST_AVR_TIMER2_RESERVED 1
+   #define SYST_AVR_TIMER2_MASK     _BV(SYST_AVR_SLOT_TIMER2)
+#else
+   #define SYST_AVR_TIMER2_RESERVED 0
+   #define SYST_AVR_TIMER2_MASK     0
+#endif
+#if !defined(USING_AVR_TIMER0B)
+   #define SYST_AVR_TIMER0B_RESERVED 1
+   #define SYST_AVR_TIMER0B_MASK    _BV(SYST_AVR_SLOT_TIMER0B)
+#else
+   #define SYST_AVR_TIMER0B_RESERVED 0
+   #define SYST_AVR_TIMER0B_MASK    0
+#endif
+#define SYST_AVR_RESERVED           (SYST_AVR_SERVO_MASK | SYST_AVR_TIMER2_MASK | SYST_AVR_TIMER0B_MASK)
+
+#define SYST_MAX_TIMERS             (SYST_AVR_SLOTS - SYST_AVR_SERVO_RESERVED - SYST_AVR_TIMER2_RESERVED - SYST_AVR_TIMER0B_RESERVED)
+
+/*
+Input capture: the 16-bit timer latches its counter into ICRn on each edge of its ICPn pin, and the capture ISR extends this
+to 32 bits with a count of timer overflows and copies it into a ring buffer that loop() reads in batches.
+The counter runs at the CPU clock (no prescaler), so timestamps wrap every 268 seconds on a 16MHz processor.
+Only the timers with an ICPn pin broken out on the board can be used:
+*/
+#if SYST_AVR_TIMER16 == 4
+   #define SYST_CAPTURE_SLOTS       (_BV(2) | _BV(3))           // ICP4 (pin 49), ICP5 (pin 48)
+#elif SYST_AVR_TIMER16 == 2
+   #define SYST_CAPTURE_SLOTS       (_BV(0) | _BV(1))           // ICP1 (pin 4), ICP3 (pin 13)
+#else
+   #define SYST_CAPTURE_SLOTS       _BV(0)                      // ICP1 (pin 8)
+#endif
+#define SYST_CAPTURE_RESERVED       (static_cast<uint8_t>(~SYST_CAPTURE_SLOTS) | SYST_AVR_RESERVED)
+#define SYST_CAPTURE_BUFFER         32                          // timestamps, must be a power of 2 no larger than 128
+#define SYST_CAPTURE_TICKS_PER_USEC (F_CPU / 1000000UL)
+
 class AVRTimer;
 extern AVRTimer* _AVRTimerTable[];
 
+extern int8_t    allocTimer(const uint8_t reserved);
 extern void      initTimer(const uint8_t timerNum);
 extern uint16_t  setTimerInterval(const uint8_t timerNum, const uint16_t msec);
 extern void      startTimer(const uint8_t timerNum);
 extern void      stopTimer(const uint8_t timerNum, const bool disableInterrupts = true);
+extern void      timerPosition(const uint8_t timerNum, uint32_t& elapsed, uint32_t& period);
+extern uint32_t  setTimerMicros(const uint8_t timerNum, const uint32_t usec);
+extern bool      retuneTimer(const uint8_t timerNum, const uint32_t usec);
+
+/*
+The Timer 2 and Timer 0 compare B vectors are each in their own compilation unit (SysTimer_AVRTimer2.cpp and
+SysTimer_AVRTimer0B.cpp) with a function that releases the slot from the reserved set, which the AVRTimer constructor
+only calls when the sketch has declared USING_AVR_TIMER2 or USING_AVR_TIMER0B. The library is linked as an archive
+(dot_a_linkage), so by default neither vector is linked, and they cannot clash with those of tone() or other libraries
+*/
+#if defined(SYST_AVR_SLOT_TIMER2) && defined(USING_AVR_TIMER2)
+   extern uint8_t useTimer2(const uint8_t reserved);
+   #define SYST_AVR_USE_TIMER2(reserved)    useTimer2(reserved)
+#else
+   #define SYST_AVR_USE_TIMER2(reserved)    (reserved)
+#endif
+#if defined(USING_AVR_TIMER0B)
+   extern uint8_t useTimer0B(const uint8_t reserved);
+   #define SYST_AVR_USE_TIMER0B(reserved)   useTimer0B(reserved)
+#else
+   #define SYST_AVR_USE_TIMER0B(reserved)   (reserved)
+#endif
+#define SYST_AVR_ALLOC(reserved)           allocTimer(SYST_AVR_USE_TIMER0B(SYST_AVR_USE_TIMER2(reserved)))
+
+// stack pointer saved on entry to the timer interrupt handlers, so a callback can find the address that was interrupted
+extern "C" volatile uint16_t _AVRInterruptSP;
+
+/*
+the timer interrupt vectors are naked trampolines that save the stack pointer in _AVRInterruptSP and jump to the
+handler proper, which is an ordinary signal handler (so it saves the registers it uses and returns with reti)
+
+this lets a callback find the interrupted address on the stack (see SysWatchdog), for 13 extra cycles per interrupt.
+The handlers' names must start with __vector, or the compiler takes them for misspelled interrupt vectors
+*/
+#define TIMER_ISR(vector, handler) \
+extern "C" void handler(void) __attribute__((signal, used)); \
+ISR(vector, ISR_NAKED) { \
+   asm volatile("push r24                     \n\t" \
+                "in   r24, __SP_L__           \n\t" \
+                "sts  _AVRInterruptSP, r24    \n\t" \
+                "in   r24, __SP_H__           \n\t" \
+                "sts  _AVRInterruptSP+1, r24  \n\t" \
+                "pop  r24                     \n\t" \
+                "jmp  " #handler "            \n\t"); \
+} \
+void handler(void)
+
+extern void      _AVRPostscaleHandler(const uint8_t timerNum);
 
 // Atmel class: Uno, Mega, etc.
 class AVRTimer : public SysTimerBase {
 public:
-   AVRTimer() {
-      if (_index + 1 <= SYST_MAX_TIMERS) {
-         _platform = Platform::T_AVR;
-         _valid = true;
-         _current = _index;
-         ++_index;
-         // save address of this object so we can access state vars from our ISR
-         _AVRTimerTable[_current] = this;
+   AVRTimer() : AVRTimer(SYST_AVR_ALLOC(SYST_AVR_RESERVED)) {
+      if (_valid) {
          initTimer(_current);
          //Serial.println(F("> CONSTRUCTOR"));
-      } else {
-         // can't return an error from a constructor, so we do this instead - we now have a "zombie" timer
-         _valid = false;
       }
    }
 
@@ -343,7 +762,12 @@ public:
             _repeating = false;
             _oneshot = true;                     // will be flipped once we get the first callback
          }
-         _interval = setTimerInterval(_current, static_cast<uint16_t>(_interval));
+         if ((_intervalUs > 0) && (_current < SYST_AVR_TIMER16)) {
+            // usec intervals select the smallest prescaler that fits, for the finest resolution
+            setIntervalMicros(setTimerMicros(_current, _intervalUs));
+         } else {
+            _interval = setTimerInterval(_current, static_cast<uint16_t>(_interval));
+         }
          startTimer(_current);
          _armed = true;
          //Serial.println(F(">>> ARM"));
@@ -353,7 +777,23 @@ public:
       return _armed;
    }
 
-   bool disarm(void) {
+   /*
+    change the interval of an armed 16-bit timer without disarming it (the 8-bit timers only have msec resolution, so this fails)
+    when called from the callback, the next callback is due one new interval after the current one
+    virtual so that derived timer classes using other hardware can refuse it
+   */
+   virtual bool retuneMicros(const uint32_t usec) {
+      if (_valid && _armed && retuneTimer(_current, usec)) {
+         _intervalUs = usec;
+         _interval = (usec + 999) / 1000;
+         return true;
+      } else {
+         return false;
+      }
+   }
+
+   // virtual so that the shim ISR stops all of the hardware used by derived timer classes
+   virtual bool disarm(void) {
       if (_valid) {
          stopTimer(_current);
          _repeating = false;
@@ -366,13 +806,236 @@ public:
       }
    }
 
-private:
+protected:
+   bool readPosition(uint32_t& elapsed, uint32_t& period) const override {
+      if (_valid && _armed) {
+         timerPosition(_current, elapsed, period);
+         return true;
+      } else {
+         return false;
+      }
+   }
+
+   // for derived classes that claim their own timer slots: slot is the one whose compare ISR calls the shim, or -1 if none available
+   explicit AVRTimer(const int8_t slot) : _current(slot) {
+      if (_current >= 0) {
+         _platform = Platform::T_AVR;
+         _valid = true;
+         _retunable = (_current < SYST_AVR_TIMER16);   // the 8-bit timers only have msec resolution
+         // save address of this object so we can access state vars from our ISR
+         _AVRTimerTable[_current] = this;
+      } else {
+         // can't return an error from a constructor, so we do this instead - we now have a "zombie" timer
+         _valid = false;
+      }
+   }
+
    int8_t      _current = -1;              // indexes the current timer
+
+private:
    // allow shim ISR to access the object private parts
    friend  void _AVRCommonHandler(AVRTimer* that);
 };
 
+#if SYST_AVR_TIMER16 == 4
+/*
+Cascaded timer pair for long, high-resolution intervals on the Mega
+
+Timer 4 toggles its OC4A output (pin 6) on every compare match, and this output clocks Timer 5 through its external
+clock input T5 (pin 47), so pin 6 MUST be wired to pin 47. Timer 5 then counts in CTC mode and interrupts once per
+full interval, so there is no per-overflow software interrupt as there is with the post-scaled timers.
+
+The interval is 2 x (OCR4A + 1) x (OCR5A + 1) x prescaler CPU cycles, giving intervals from a few usec up to 4294 sec
+with a resolution of better than 1 part in 32768. This timer reserves both the Timer 4 and Timer 5 slots.
+*/
+#define SYST_CASCADE_OUT_PIN     6                  // OC4A, Timer 4 compare output
+#define SYST_CASCADE_IN_PIN      47                 // T5, Timer 5 external clock input
+
+extern int8_t    claimTimers(const uint8_t slots, const int8_t isrSlot);
+extern uint32_t  setCascadeInterval(const uint32_t usec);
+extern void      startCascade(void);
+extern void      stopCascade(void);
+extern void      cascadePosition(uint32_t& elapsed, uint32_t& period);
+
+class AVRCascadeTimer : public AVRTimer {
+public:
+   AVRCascadeTimer() : AVRTimer(claimTimers(_BV(2) | _BV(3), 3)) {
+      _retunable = false;
+   }
+
+   bool arm(const bool repeat) {
+      if (_valid && (_callback != nullptr) && (_interval > 0)) {
+         if (repeat) {
+            _repeating = true;
+            _oneshot = false;
+         } else {
+            _repeating = false;
+            _oneshot = true;                     // will be flipped once we get the first callback
+         }
+         // intervals set in msec beyond the range of the usec counter are clamped to it
+         uint32_t usec = (_intervalUs > 0) ? _intervalUs : ((_interval > 4294967UL) ? 0xFFFFFFFFUL : _interval * 1000UL);
+         setIntervalMicros(setCascadeInterval(usec));
+         startCascade();
+         _armed = true;
+      } else {
+         _armed = false;
+      }
+      return _armed;
+   }
+
+   // the cascade interval is factored across both timers, so it cannot be changed on the fly
+   bool retuneMicros(const uint32_t usec) override {
+      (void)usec;
+      return false;
+   }
+
+   bool disarm(void) override {
+      if (_valid) {
+         stopCascade();
+         _repeating = false;
+         _oneshot = false;
+         _armed = false;
+         return true;
+      } else {
+         return false;
+      }
+   }
+
+protected:
+   bool readPosition(uint32_t& elapsed, uint32_t& period) const override {
+      if (_valid && _armed) {
+         cascadePosition(elapsed, period);
+         return true;
+      } else {
+         return false;
+      }
+   }
+};
+#endif
+
 
 #endif // architecture
 
+#ifdef SYST_CAPTURE_SLOTS
+/*
+Input capture class (AVR and SAM)
+
+Allocated from the same pool as the SysTimer objects, so declare it before any SysTimer objects that might otherwise take the timer.
+The ISR is the only writer of _head and loop() is the only writer of _tail, and each is a single byte, so the ring buffer
+needs no locking. If the buffer fills, new timestamps are dropped (and counted) rather than overwriting unread ones.
+*/
+class SysCapture;
+
+extern SysCapture* _SysCaptureTable[];
+
+extern bool    startCapture(const uint8_t timerNum, const CaptureEdge edge);
+extern void    stopCapture(const uint8_t timerNum);
+extern int8_t  capturePin(const uint8_t timerNum);
+
+class SysCapture {
+public:
+   SysCapture() {
+      _current = allocTimer(SYST_CAPTURE_RESERVED);
+      if (_current >= 0) {
+         _valid = true;
+         // save address of this object so we can access it from our ISR
+         _SysCaptureTable[_current] = this;
+      }
+   }
+
+   bool begin(void) const { return _valid; }
+
+   // start timestamping edges on the capture pin, discarding any unread timestamps
+   bool start(const CaptureEdge edge = CaptureEdge::C_RISING) {
+      if (_valid) {
+         stopCapture(_current);
+         _head = 0;
+         _tail = 0;
+         _overruns = 0;
+         _edge = edge;
+         _running = startCapture(_current, edge);
+         return _running;
+      } else {
+         return false;
+      }
+   }
+
+   bool stop(void) {
+      if (_valid) {
+         stopCapture(_current);
+         _running = false;
+         return true;
+      } else {
+         return false;
+      }
+   }
+
+   // number of unread timestamps
+   uint8_t available(void) const {
+      return static_cast<uint8_t>(_head - _tail);
+   }
+
+   /*
+    copy up to count of the oldest unread timestamps (in timer ticks, see SYST_CAPTURE_TICKS_PER_USEC) to dest
+    returns the number copied
+   */
+   uint16_t read(uint32_t* dest, const uint16_t count) {
+      uint8_t  head = _head;                     // the ISR only ever adds entries beyond this point
+      uint8_t  tail = _tail;
+      uint16_t copied = 0;
+
+      while ((tail != head) && (copied < count)) {
+         dest[copied++] = _buffer[tail & (SYST_CAPTURE_BUFFER - 1)];
+         ++tail;
+      }
+      _tail = tail;
+      return copied;
+   }
+
+   // number of timestamps dropped because the buffer was full
+   uint16_t getOverruns(void) const {
+      SYST_LOCK();
+      uint16_t count = _overruns;
+      SYST_UNLOCK();
+      return count;
+   }
+
+   int8_t getPin(void) const {
+      return _valid ? capturePin(_current) : -1;
+   }
+
+   CaptureEdge getEdge(void) const {
+      return _edge;
+   }
+
+   bool running(void) const {
+      return _running;
+   }
+
+private:
+   bool              _valid = false;
+   bool              _running = false;
+   int8_t            _current = -1;              // indexes the timer slot
+   CaptureEdge       _edge = CaptureEdge::C_RISING;
+   volatile uint8_t  _head = 0;                  // next entry to be written by the ISR
+   volatile uint8_t  _tail = 0;                  // next entry to be read by loop()
+   volatile uint16_t _overruns = 0;
+   volatile uint32_t _buffer[SYST_CAPTURE_BUFFER];
+
+   friend void _SysCaptureHandler(SysCapture* that, const uint32_t timestamp);
+};
+
+// called from the capture ISR with the latched counter value
+inline void _SysCaptureHandler(SysCapture* that, const uint32_t timestamp) {
+   uint8_t head = that->_head;
+
+   if (static_cast<uint8_t>(head - that->_tail) >= SYST_CAPTURE_BUFFER) {
+      ++that->_overruns;
+   } else {
+      that->_buffer[head & (SYST_CAPTURE_BUFFER - 1)] = timestamp;
+      that->_head = head + 1;                    // publish only after the entry is written
+   }
+}
+#endif
+
 #endif //header protect
@@ -29,23 +29,104 @@ To view a copy of this license, visit https://creativecommons.org/licenses/by-sa
 #define TIMER_CTC(T)        OCIE ## T ## A
 #define TIMER_CMR(T)        OCR ## T ## A
 
+// software post-scaler state for the 8-bit timer slots, indexed by (slot - SYST_AVR_TIMER16)
+#define POSTSCALE_SLOTS     (SYST_AVR_SLOTS - SYST_AVR_TIMER16)
+#define POSTSCALE(slot)     ((slot) - SYST_AVR_TIMER16)
+
+static uint16_t          _AVRPostscale[POSTSCALE_SLOTS] = { 0 };          // number of base interrupts per interval
+static volatile uint16_t _AVRPostcount[POSTSCALE_SLOTS] = { 0 };          // base interrupts remaining in the current interval
+
+// base interrupt period in usec for the 8-bit timers
+#define TIMER2_BASE_USEC    1000UL
+#define TIMER0_BASE_USEC    ((64UL * 256UL * 1000UL) / (F_CPU / 1000UL))      // 64 pre-scaler, 256 ticks per overflow cycle
+
+#define TICKS_TO_USEC(ticks, prescale)  ((static_cast<uint32_t>(ticks) * (prescale)) / (F_CPU / 1000000UL))
+
+static uint8_t _AVRSlotsInUse = 0;                  // bitmap of allocated timer slots
+
+// clock select bits for each 16-bit timer: 1024 pre-scaler for msec intervals, the smallest that fits for usec intervals
+#define PRESCALE_1024       (_BV(CS10) | _BV(CS12))
+
+static uint8_t _AVRPrescaleBits[SYST_AVR_TIMER16];
+
+// divisor for each clock select value (CS12:CS10), 0 for the external clock selections
+static const uint16_t _AVRPrescaleDivisor[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+
+// counter and compare registers of a 16-bit timer slot
+static void timerRegisters(const uint8_t timerNum, volatile uint16_t*& count, volatile uint16_t*& top) {
+   switch (timerNum) {
+#if SYST_AVR_TIMER16 >= 2
+   case 1:
+      count = &TCNT3;
+      top = &TIMER_CMR(3);
+      break;
+#if SYST_AVR_TIMER16 == 4
+   case 2:
+      count = &TCNT4;
+      top = &TIMER_CMR(4);
+      break;
+   case 3:
+      count = &TCNT5;
+      top = &TIMER_CMR(5);
+      break;
+#endif
+#endif
+   default:
+      count = &TCNT1;
+      top = &TIMER_CMR(1);
+      break;
+   }
+}
+
+/*
+allocate the first free timer slot that is not reserved for another library
+
+returns -1 if there are none left
+*/
+int8_t allocTimer(const uint8_t reserved) {
+   for (uint8_t slot = 0; slot < SYST_AVR_SLOTS; slot++) {
+      if (!((_AVRSlotsInUse | reserved) & _BV(slot))) {
+         _AVRSlotsInUse |= _BV(slot);
+         return slot;
+      }
+   }
+   return -1;
+}
+
+/*
+claim a specific set of timer slots, all or nothing, for timer classes that need particular hardware
+
+returns isrSlot if all the slots were free, else -1
+*/
+int8_t claimTimers(const uint8_t slots, const int8_t isrSlot) {
+   if (_AVRSlotsInUse & slots) {
+      return -1;
+   }
+   _AVRSlotsInUse |= slots;
+   return isrSlot;
+}
+
 /*
 stop a timer by clearing the timer control registers
-by default, disables interrupts
+by default, disables interrupts, restoring the previous state afterwards so that a timer can be disarmed from a callback
+
+Timer 0 must keep running for millis(), so for compare B we disable the interrupt instead
 */
 void stopTimer (const uint8_t timerNum, const bool disableInterrupts) {
+   uint8_t savedSREG = SREG;
+
    if (disableInterrupts) cli();
    switch (timerNum) {
    case 0:
       TIMER_CONTROL(1, A) = 0;                 // technically, the timer stops when the CSx bits in segment B are cleared, but clear this too for insurance
       TIMER_CONTROL(1, B) = 0;
       break;
-#if SYST_MAX_TIMERS >= 2
+#if SYST_AVR_TIMER16 >= 2
    case 1:
       TIMER_CONTROL(3, A) = 0;
       TIMER_CONTROL(3, B) = 0;
       break;
-#if SYST_MAX_TIMERS == 4
+#if SYST_AVR_TIMER16 == 4
    case 2:
       TIMER_CONTROL(4, A) = 0;
       TIMER_CONTROL(4, B) = 0;
@@ -56,25 +137,36 @@ void stopTimer (const uint8_t timerNum, const bool disableInterrupts) {
       break;
 #endif
 #endif
+#ifdef SYST_AVR_SLOT_TIMER2
+   case SYST_AVR_SLOT_TIMER2:
+      TIMER_CONTROL(2, A) = 0;
+      TIMER_CONTROL(2, B) = 0;
+      break;
+#endif
+   case SYST_AVR_SLOT_TIMER0B:
+      TIMER_MASK(0) &= ~_BV(OCIE0B);
+      break;
    }
-   if (disableInterrupts) sei();
+   if (disableInterrupts) SREG = savedSREG;
 }
 
 /*
 initialize a timer by setting the timer compare interrupt bit in the timer mask register
+
+Timer 0 compare B is enabled in startTimer instead, since it is the only way to stop it
 */
 void initTimer(const uint8_t timerNum) {
-   cli();
+   SYST_LOCK();
    stopTimer(timerNum, false);
    switch (timerNum) {
    case 0:
       TIMER_MASK(1) |= _BV(TIMER_CTC(1));
       break;
-#if SYST_MAX_TIMERS >= 2
+#if SYST_AVR_TIMER16 >= 2
    case 1:
       TIMER_MASK(3) |= _BV(TIMER_CTC(3));
       break;
-#if SYST_MAX_TIMERS == 4
+#if SYST_AVR_TIMER16 == 4
    case 2:
       TIMER_MASK(4) |= _BV(TIMER_CTC(4));
       break;
@@ -82,40 +174,68 @@ void initTimer(const uint8_t timerNum) {
       TIMER_MASK(5) |= _BV(TIMER_CTC(5));
       break;
 #endif
+#endif
+#ifdef SYST_AVR_SLOT_TIMER2
+   case SYST_AVR_SLOT_TIMER2:
+      TIMER_MASK(2) |= _BV(TIMER_CTC(2));
+      break;
 #endif
    }
-   sei();
+   SYST_UNLOCK();
 }
 
 /*
 start a timer by setting the control bits
 
-uses a fixed prescaler of 1024 (bits CS10 and CS12)
+16-bit timers use the prescaler selected by setTimerInterval (1024, bits CS10 and CS12) or setTimerMicros
 also set WGM12 to enable the timer compare match mode (CTC)
+the control register is assigned rather than ORed, since arm() may be called again without disarm() and with a
+different prescaler, and the counter and any pending compare match are cleared so the interval starts from now
+
+Timer 2 uses a prescaler of 64 (bit CS22) in CTC mode (bit WGM21)
 
 Setting the control bits starts the timer. Once started, the timer countines to count until stopped
 */
+#define START_TIMER16(T, slot) \
+   TIMER_CONTROL(T, B) = 0; \
+   TCNT ## T = 0; \
+   TIFR ## T = _BV(OCF ## T ## A); \
+   TIMER_CONTROL(T, B) = _AVRPrescaleBits[slot] | _BV(WGM12)
+
 void startTimer(const uint8_t timerNum) {
-   cli();
+   SYST_LOCK();
    switch (timerNum) {
    case 0:
-      TIMER_CONTROL(1, B) |= (_BV(CS10) | _BV(CS12) | _BV(WGM12));
+      START_TIMER16(1, 0);
       break;
-#if SYST_MAX_TIMERS >= 2
+#if SYST_AVR_TIMER16 >= 2
    case 1:
-      TIMER_CONTROL(3, B) |= (_BV(CS10) | _BV(CS12) | _BV(WGM12));
+      START_TIMER16(3, 1);
       break;
-#if SYST_MAX_TIMERS == 4
+#if SYST_AVR_TIMER16 == 4
    case 2:
-      TIMER_CONTROL(4, B) |= (_BV(CS10) | _BV(CS12) | _BV(WGM12));
+      START_TIMER16(4, 2);
       break;
    case 3:
-      TIMER_CONTROL(5, B) |= (_BV(CS10) | _BV(CS12) | _BV(WGM12));
+      START_TIMER16(5, 3);
       break;
 #endif
 #endif
+#ifdef SYST_AVR_SLOT_TIMER2
+   case SYST_AVR_SLOT_TIMER2:
+      _AVRPostcount[POSTSCALE(timerNum)] = _AVRPostscale[POSTSCALE(timerNum)];
+      TCNT2 = 0;
+      TIMER_CONTROL(2, A) = _BV(WGM21);
+      TIMER_CONTROL(2, B) = _BV(CS22);
+      break;
+#endif
+   case SYST_AVR_SLOT_TIMER0B:
+      _AVRPostcount[POSTSCALE(timerNum)] = _AVRPostscale[POSTSCALE(timerNum)];
+      TIFR0 = _BV(OCF0B);                       // discard any stale compare match
+      TIMER_MASK(0) |= _BV(OCIE0B);
+      break;
    }
-   sei();
+   SYST_UNLOCK();
 }
 
 /*
@@ -133,10 +253,29 @@ for this mode, we calculate the initial value of the counter as follows:
   note: it is -1 because 0 is counted also
 and load this value into the timer compare match register
 
+for the 8-bit timers, the compare match register is fixed for the base interrupt rate,
+and we calculate the number of base interrupts per interval instead
+
 Returns the set interval, possibly constrained
 */
 uint16_t setTimerInterval(const uint8_t timerNum, const uint16_t msec) {
-   cli();
+   if (timerNum >= SYST_AVR_TIMER16) {
+      uint32_t base = (timerNum == SYST_AVR_SLOT_TIMER0B) ? TIMER0_BASE_USEC : TIMER2_BASE_USEC;
+      uint32_t count = ((static_cast<uint32_t>(msec) * 1000UL) + (base / 2)) / base;
+      count = constrain(count, 1UL, 65535UL);
+
+      SYST_LOCK();
+      _AVRPostscale[POSTSCALE(timerNum)] = static_cast<uint16_t>(count);
+#ifdef SYST_AVR_SLOT_TIMER2
+      if (timerNum == SYST_AVR_SLOT_TIMER2) {
+         TIMER_CMR(2) = static_cast<uint8_t>((F_CPU / 64UL / 1000UL) - 1);
+      }
+#endif
+      SYST_UNLOCK();
+      return static_cast<uint16_t>(((count * base) + 500UL) / 1000UL);
+   }
+
+   SYST_LOCK();
    uint16_t maximum = static_cast<uint16_t>((MAX_INTERVAL) * 1000.0);
    uint16_t interval = constrain(msec, 1, maximum);
    double elapsed = static_cast<double>(interval) / 1000.0;
@@ -147,11 +286,11 @@ uint16_t setTimerInterval(const uint8_t timerNum, const uint16_t msec) {
    case 0:
       TIMER_CMR(1) = counter;
       break;
-#if SYST_MAX_TIMERS >= 2
+#if SYST_AVR_TIMER16 >= 2
    case 1:
       TIMER_CMR(3) = counter;
       break;
-#if SYST_MAX_TIMERS == 4
+#if SYST_AVR_TIMER16 == 4
    case 2:
       TIMER_CMR(4) = counter;
       break;
@@ -161,51 +300,303 @@ uint16_t setTimerInterval(const uint8_t timerNum, const uint16_t msec) {
 #endif
 #endif
    }
-   sei();
+   _AVRPrescaleBits[timerNum] = PRESCALE_1024;
+   SYST_UNLOCK();
    return interval;
 }
 
+/*
+set a usec interval on a 16-bit timer, using the smallest prescaler that reaches it for the finest resolution:
+at 16MHz that is 1/16 usec up to 4.096 msec, 1/2 usec up to 32.768 msec, and so on up to the 1024 prescaler limit
+
+Returns the set interval in usec, possibly rounded or constrained
+*/
+uint32_t setTimerMicros(const uint8_t timerNum, const uint32_t usec) {
+   static const uint8_t prescaleBits[] = { _BV(CS10), _BV(CS11), _BV(CS11) | _BV(CS10), _BV(CS12), PRESCALE_1024 };
+   uint64_t cycles = static_cast<uint64_t>(usec) * (F_CPU / 1000000UL);
+   uint8_t  bits = PRESCALE_1024;
+   volatile uint16_t* count;
+   volatile uint16_t* top;
+
+   for (uint8_t i = 0; i < sizeof(prescaleBits); i++) {
+      bits = prescaleBits[i];
+      if (cycles <= (65536ULL * _AVRPrescaleDivisor[bits])) {
+         break;
+      }
+   }
+   uint32_t divisor = _AVRPrescaleDivisor[bits];
+   uint32_t ticks = static_cast<uint32_t>((cycles + (divisor / 2)) / divisor);
+   ticks = constrain(ticks, 2UL, 65536UL);
+
+   timerRegisters(timerNum, count, top);
+   SYST_LOCK();
+   *top = static_cast<uint16_t>(ticks - 1);
+   _AVRPrescaleBits[timerNum] = bits;
+   SYST_UNLOCK();
+   return TICKS_TO_USEC(ticks, divisor);
+}
+
+/*
+change the interval of a running 16-bit timer while keeping its prescaler, so the timer does not have to be stopped
+the new compare value applies to the period in progress, so when called from the callback (the counter is near 0) the next
+interrupt is one new interval after this one. If the counter has already passed the new compare value it would run on to
+0xFFFF, so we restart the period instead
+
+Restores the interrupt state rather than enabling interrupts, as this may be called from the callback
+
+returns false for the 8-bit timers, or if the interval cannot be reached with the current prescaler
+*/
+bool retuneTimer(const uint8_t timerNum, const uint32_t usec) {
+   if (timerNum >= SYST_AVR_TIMER16) {
+      return false;
+   }
+
+   uint32_t divisor = _AVRPrescaleDivisor[_AVRPrescaleBits[timerNum]];
+   uint32_t ticks = static_cast<uint32_t>(((static_cast<uint64_t>(usec) * (F_CPU / 1000000UL)) + (divisor / 2)) / divisor);
+   volatile uint16_t* count;
+   volatile uint16_t* top;
+
+   if ((ticks < 2) || (ticks > 65536UL)) {
+      return false;
+   }
+   timerRegisters(timerNum, count, top);
+
+   SYST_LOCK();
+   *top = static_cast<uint16_t>(ticks - 1);
+   if (*count >= *top) {
+      *count = 0;
+   }
+   SYST_UNLOCK();
+   return true;
+}
+
+#if SYST_AVR_TIMER16 == 4
+/*
+cascaded Timer 4 -> Timer 5 pair (see AVRCascadeTimer)
+
+the interval in CPU cycles is 2 x A x B x P, where A = OCR4A + 1, B = OCR5A + 1 and P is the Timer 4 prescaler
+we use the smallest prescaler that reaches the interval (1, else 8), then the smallest A that keeps B within 16 bits,
+which gives the finest resolution
+
+A is at least 2 so that the Timer 4 output is slow enough for the T5 input synchronizer to see every edge
+
+Returns the set interval in usec, possibly rounded
+*/
+static uint8_t _cascadePrescaleBits = _BV(CS40);          // Timer 4 clock select bits for the current interval
+
+uint32_t setCascadeInterval(const uint32_t usec) {
+   uint64_t cycles = static_cast<uint64_t>(usec) * (F_CPU / 1000000UL);
+   uint8_t  prescaleBits = _BV(CS40);
+   uint16_t prescale = 1;
+
+   if (cycles > (2ULL * 65536ULL * 65536ULL)) {
+      prescaleBits = _BV(CS41);
+      prescale = 8;
+   }
+   uint64_t units = cycles / (2 * prescale);                                          // Timer 5 clock periods at A = 1
+   uint32_t a = static_cast<uint32_t>((units + 65535ULL) / 65536ULL);
+   a = constrain(a, 2UL, 65536UL);
+   uint32_t b = static_cast<uint32_t>((units + (a / 2)) / a);
+   b = constrain(b, 1UL, 65536UL);
+
+   SYST_LOCK();
+   OCR4A = static_cast<uint16_t>(a - 1);
+   OCR5A = static_cast<uint16_t>(b - 1);
+   _cascadePrescaleBits = prescaleBits;
+   SYST_UNLOCK();
+   return static_cast<uint32_t>((2ULL * a * b * prescale) / (F_CPU / 1000000UL));
+}
+
+/*
+start Timer 5 first, so that it is waiting on its external clock when Timer 4 starts toggling OC4A
+*/
+void startCascade(void) {
+   SYST_LOCK();
+   TIMER_CONTROL(4, B) = 0;
+   TIMER_CONTROL(5, B) = 0;
+   TCNT4 = 0;
+   TCNT5 = 0;
+   DDRH |= _BV(PH3);                                                                   // OC4A (pin 6) output
+   DDRL &= ~_BV(PL2);                                                                  // T5 (pin 47) input
+   TIMER_MASK(4) &= ~_BV(TIMER_CTC(4));                                                // only Timer 5 interrupts
+   TIFR5 = _BV(OCF5A);
+   TIMER_MASK(5) |= _BV(TIMER_CTC(5));
+   TIMER_CONTROL(5, A) = 0;
+   TIMER_CONTROL(5, B) = _BV(WGM52) | _BV(CS52) | _BV(CS51) | _BV(CS50);              // CTC, external clock on rising edge
+   TIMER_CONTROL(4, A) = _BV(COM4A0);                                                  // toggle OC4A on compare match
+   TIMER_CONTROL(4, B) = _BV(WGM42) | _cascadePrescaleBits;                            // CTC
+   SYST_UNLOCK();
+}
+
+/*
+Timer 5 counts one for every two Timer 4 compare matches (one full cycle of OC4A): OC4A goes high on the first
+match, which clocks Timer 5, and low on the second. So if OC4A is high we are in the first half of the Timer 5 count,
+and if it is low we are A Timer 4 counts further on
+*/
+void cascadePosition(uint32_t& elapsed, uint32_t& period) {
+   uint8_t  prescale = (_cascadePrescaleBits == _BV(CS41)) ? 8 : 1;
+
+   SYST_LOCK();
+   uint32_t a = static_cast<uint32_t>(OCR4A) + 1;
+   uint32_t b = static_cast<uint32_t>(OCR5A) + 1;
+   uint32_t count5 = TCNT5;
+   uint32_t count4 = TCNT4;
+   bool     high = PINH & _BV(PH3);
+   SYST_UNLOCK();
+
+   uint64_t cycles = ((static_cast<uint64_t>(count5) * 2 * a) + (high ? 0 : a) + count4) * prescale;
+   elapsed = static_cast<uint32_t>(cycles / (F_CPU / 1000000UL));
+   period = static_cast<uint32_t>((2ULL * a * b * prescale) / (F_CPU / 1000000UL));
+}
+
+void stopCascade(void) {
+   SYST_LOCK();
+   TIMER_CONTROL(4, A) = 0;                                                            // also releases the OC4A pin
+   TIMER_CONTROL(4, B) = 0;
+   TIMER_CONTROL(5, A) = 0;
+   TIMER_CONTROL(5, B) = 0;
+   SYST_UNLOCK();
+}
+#endif
+
+/*
+read the position within the current period from the live counter
+
+16-bit timers: in CTC mode the counter restarts from 0 on the compare match, so the counter is the elapsed count
+even if the compare interrupt is still pending
+
+8-bit timers: the elapsed time is the number of completed base interrupts plus the count since the last one.
+If the compare flag is set, a base interrupt is pending that the post-scaler has not counted yet. If the counter
+was read after it (the count is small), we count that base interrupt ourselves; if the counter is large, the
+flag was set after we read it, so the count already reflects the whole base period
+*/
+
+void timerPosition(const uint8_t timerNum, uint32_t& elapsed, uint32_t& period) {
+   uint16_t count = 0;
+   uint16_t top = 0;
+
+   if (timerNum >= SYST_AVR_TIMER16) {
+      uint8_t  ticks;
+      bool     pending;
+      uint32_t base;
+      uint16_t postscale = _AVRPostscale[POSTSCALE(timerNum)];
+
+      SYST_LOCK();
+#ifdef SYST_AVR_SLOT_TIMER2
+      if (timerNum == SYST_AVR_SLOT_TIMER2) {
+         ticks = TCNT2;
+         pending = (TIFR2 & _BV(OCF2A)) && (ticks < (TIMER_CMR(2) / 2));
+         base = TIMER2_BASE_USEC;
+      } else
+#endif
+      {
+         ticks = static_cast<uint8_t>(TCNT0 - OCR0B);                       // the compare B interrupt fires as TCNT0 passes OCR0B
+         pending = (TIFR0 & _BV(OCF0B)) && (ticks < 128);
+         base = TIMER0_BASE_USEC;
+      }
+      uint16_t completed = postscale - _AVRPostcount[POSTSCALE(timerNum)];
+      SYST_UNLOCK();
+
+      if (pending) {
+         ++completed;
+      }
+      if (completed >= postscale) {
+         completed -= postscale;                                               // the period has ended but its interrupt is pending
+      }
+      elapsed = (static_cast<uint32_t>(completed) * base) + TICKS_TO_USEC(ticks, 64UL);
+      period = static_cast<uint32_t>(postscale) * base;
+      return;
+   }
+
+   SYST_LOCK();
+   switch (timerNum) {
+   case 0:
+      count = TCNT1;
+      top = TIMER_CMR(1);
+      break;
+#if SYST_AVR_TIMER16 >= 2
+   case 1:
+      count = TCNT3;
+      top = TIMER_CMR(3);
+      break;
+#if SYST_AVR_TIMER16 == 4
+   case 2:
+      count = TCNT4;
+      top = TIMER_CMR(4);
+      break;
+   case 3:
+      count = TCNT5;
+      top = TIMER_CMR(5);
+      break;
+#endif
+#endif
+   }
+   uint32_t prescale = _AVRPrescaleDivisor[_AVRPrescaleBits[timerNum]];
+   SYST_UNLOCK();
+   elapsed = TICKS_TO_USEC(count, prescale);
+   period = TICKS_TO_USEC(static_cast<uint32_t>(top) + 1, prescale);
+}
+
 // allows us to emulate use of "this" in the interrupt handlers referenced through the above callback table
-AVRTimer* _AVRTimerTable[SYST_MAX_TIMERS] = { nullptr };
+AVRTimer*   _AVRTimerTable[SYST_AVR_SLOTS] = { nullptr };
 
 /*
 Shim ISR that associates the interrupt with the initiatiating timer object and the calls the user's callback function
 with the provided (non-optional) argument
+
+a callback that re-enables interrupts (e.g. to use Serial) and overruns its interval would otherwise be called again
+from inside itself, so an interrupt that arrives while the timer's own callback is running is skipped
 */
 void _AVRCommonHandler(AVRTimer* that) {
-   if (that->_repeating || that->_oneshot) {
+   if ((that->_repeating || that->_oneshot) && !that->_inCallback) {
+      if (that->_oneshot) {
+         // stop the timer before the callback rather than after, so the callback can re-arm it
+         that->_oneshot = false;
+         that->disarm();
+      }
+      ++that->_fireCount;
+      that->_inCallback = true;
       (*(that->_callback))(that->_callbackArg);                                       // std::bind unavailable
+      that->_inCallback = false;
    }
-   if (that->_oneshot) {
-      that->_oneshot = false;
-      that->disarm();
+}
+
+/*
+software post-scaler for the 8-bit timers: only call the shim once the interval has elapsed
+*/
+void _AVRPostscaleHandler(const uint8_t timerNum) {
+   if (--_AVRPostcount[POSTSCALE(timerNum)] == 0) {
+      _AVRPostcount[POSTSCALE(timerNum)] = _AVRPostscale[POSTSCALE(timerNum)];
+      _AVRCommonHandler(_AVRTimerTable[timerNum]);
    }
 }
 
+volatile uint16_t _AVRInterruptSP = 0;                // saved by the TIMER_ISR trampolines (see SysTimer.h)
+
 /*
 Function macros for timer interrupt handlers
 Notes:
 1. for one-shot timers, clear the timer control register "B" here to stop the timer
 2. interrupts are disabled in this macro
 */
-ISR(TIMER1_COMPA_vect) {
+TIMER_ISR(TIMER1_COMPA_vect, __vector_SysTimer1) {
    _AVRCommonHandler(_AVRTimerTable[0]);
 }
 
-#if SYST_MAX_TIMERS >= 2
+#if SYST_AVR_TIMER16 >= 2
 
-ISR(TIMER3_COMPA_vect) {
+TIMER_ISR(TIMER3_COMPA_vect, __vector_SysTimer3) {
    _AVRCommonHandler(_AVRTimerTable[1]);
 }
-#if SYST_MAX_TIMERS == 4
-ISR(TIMER4_COMPA_vect) {
+#if SYST_AVR_TIMER16 == 4
+TIMER_ISR(TIMER4_COMPA_vect, __vector_SysTimer4) {
    _AVRCommonHandler(_AVRTimerTable[2]);
 }
 
-ISR(TIMER5_COMPA_vect) {
+TIMER_ISR(TIMER5_COMPA_vect, __vector_SysTimer5) {
    _AVRCommonHandler(_AVRTimerTable[3]);
 }
 #endif
 #endif
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,153 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysTimer.h>
+
+
+#if defined(__AVR__)
+
+/*
+kept apart from SysTimer_AVR.cpp so that the capture and overflow vectors are only linked into sketches that declare a
+SysCapture object (the library is linked as an archive, see library.properties), and do not clash with other libraries
+that use these vectors
+*/
+SysCapture* _SysCaptureTable[SYST_AVR_TIMER16] = { nullptr };
+
+/*
+input capture (see SysCapture)
+
+the timer runs in normal mode with no prescaler, and the overflow ISR counts the upper 16 bits of the timestamp
+the noise canceler is always enabled, which delays each capture by 4 CPU cycles but does not affect the timestamp spacing
+for both edges, we capture the rising edge first and the capture ISR toggles the edge select bit after each capture
+*/
+static volatile uint16_t _AVRCaptureHigh[SYST_AVR_TIMER16] = { 0 };       // overflow count for each capture timer
+
+// capture pin for each 16-bit timer, -1 if not broken out on the board
+#if SYST_AVR_TIMER16 == 4
+static const int8_t _AVRCapturePins[SYST_AVR_TIMER16] = { -1, -1, 49, 48 };
+#elif SYST_AVR_TIMER16 == 2
+static const int8_t _AVRCapturePins[SYST_AVR_TIMER16] = { 4, 13 };
+#else
+static const int8_t _AVRCapturePins[SYST_AVR_TIMER16] = { 8 };
+#endif
+
+#define CAPTURE_START(T) \
+   TIMER_CONTROL(T, A) = 0; \
+   TIMER_CONTROL(T, B) = _BV(ICNC ## T) | ((edge == CaptureEdge::C_FALLING) ? 0 : _BV(ICES ## T)) | _BV(CS ## T ## 0); \
+   TCNT ## T = 0; \
+   TIFR ## T = _BV(ICF ## T) | _BV(TOV ## T); \
+   TIMER_MASK(T) = _BV(ICIE ## T) | _BV(TOIE ## T)
+
+#define CAPTURE_STOP(T) \
+   TIMER_MASK(T) = 0; \
+   TIMER_CONTROL(T, B) = 0
+
+bool startCapture(const uint8_t timerNum, const CaptureEdge edge) {
+   if (_AVRCapturePins[timerNum] < 0) {
+      return false;
+   }
+   pinMode(_AVRCapturePins[timerNum], INPUT);
+   cli();
+   _AVRCaptureHigh[timerNum] = 0;
+   switch (timerNum) {
+#if SYST_AVR_TIMER16 == 4
+   case 2:
+      CAPTURE_START(4);
+      break;
+   case 3:
+      CAPTURE_START(5);
+      break;
+#else
+   case 0:
+      CAPTURE_START(1);
+      break;
+#if SYST_AVR_TIMER16 == 2
+   case 1:
+      CAPTURE_START(3);
+      break;
+#endif
+#endif
+   }
+   sei();
+   return true;
+}
+
+void stopCapture(const uint8_t timerNum) {
+   cli();
+   switch (timerNum) {
+#if SYST_AVR_TIMER16 == 4
+   case 2:
+      CAPTURE_STOP(4);
+      break;
+   case 3:
+      CAPTURE_STOP(5);
+      break;
+#else
+   case 0:
+      CAPTURE_STOP(1);
+      break;
+#if SYST_AVR_TIMER16 == 2
+   case 1:
+      CAPTURE_STOP(3);
+      break;
+#endif
+#endif
+   }
+   sei();
+}
+
+int8_t capturePin(const uint8_t timerNum) {
+   return _AVRCapturePins[timerNum];
+}
+
+/*
+capture and overflow ISRs for one timer
+
+if an overflow is pending when the capture ISR runs (the capture ISR has priority) and the captured value is in the
+lower half of the count, the capture happened after the overflow, so it belongs to the next overflow count
+*/
+#define CAPTURE_ISRS(T, slot) \
+ISR(TIMER ## T ## _OVF_vect) { \
+   ++_AVRCaptureHigh[slot]; \
+} \
+ISR(TIMER ## T ## _CAPT_vect) { \
+   uint16_t low = ICR ## T; \
+   uint16_t high = _AVRCaptureHigh[slot]; \
+   if ((TIFR ## T & _BV(TOV ## T)) && (low < 0x8000)) { \
+      ++high; \
+   } \
+   if (_SysCaptureTable[slot]->getEdge() == CaptureEdge::C_BOTH) { \
+      TIMER_CONTROL(T, B) ^= _BV(ICES ## T); \
+      TIFR ## T = _BV(ICF ## T);                          /* changing the edge may set the capture flag */ \
+   } \
+   _SysCaptureHandler(_SysCaptureTable[slot], (static_cast<uint32_t>(high) << 16) | low); \
+}
+
+#if SYST_AVR_TIMER16 == 4
+CAPTURE_ISRS(4, 2)
+CAPTURE_ISRS(5, 3)
+#else
+CAPTURE_ISRS(1, 0)
+#if SYST_AVR_TIMER16 == 2
+CAPTURE_ISRS(3, 1)
+#endif
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysTimer.h>
+
+
+#if defined(__AVR__)
+
+/*
+Timer 0 compare B vector, kept apart from SysTimer_AVR.cpp so that it is only linked when a sketch uses Timer 0 compare B:
+the AVRTimer constructor only calls useTimer0B if USING_AVR_TIMER0B is declared (see SysTimer.h)
+*/
+uint8_t useTimer0B(const uint8_t reserved) {
+   return reserved & ~_BV(SYST_AVR_SLOT_TIMER0B);
+}
+
+TIMER_ISR(TIMER0_COMPB_vect, __vector_SysTimer0B) {
+   _AVRPostscaleHandler(SYST_AVR_SLOT_TIMER0B);
+}
+
+#endif
@@ -0,0 +1,442 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysTimer.h>
+
+#if defined(ESP8266)
+
+/*
+Shim callback for the per-object os_timer: the SDK passes the timer object as the argument,
+so we can clear the armed state for one-shot timers and then call the user's callback with the user's argument
+*/
+void _ESPCommonHandler(void* arg) {
+   ESPTimer* that = static_cast<ESPTimer*>(arg);
+
+   if (that->_oneshot) {
+      that->_oneshot = false;
+      that->_armed = false;
+   }
+   that->_periodStart = micros();
+   ++that->_fireCount;
+   (*(that->_callback))(that->_callbackArg);
+}
+
+/*
+single os_timer multiplexer for ESPTimer (USING_ESP_TIMER_MUX)
+
+armed timers are kept in a binary min-heap ordered by deadline; each timer records its own heap position
+so that re-arming is O(log n) rather than a search
+
+disarmed timers are left in the heap (with _armed false) until they reach the top, so disarm() only writes the
+timer's own flags; re-arming a disarmed timer that is still in the heap just moves it. disarm() may be called from
+an interrupt handler, so each place that tests _armed and then acts on it does so with interrupts disabled. The
+heap itself is only changed from the SDK context
+*/
+static os_timer_t _muxTimer;
+static bool       _muxTimerInit = false;
+static bool       _muxScheduled = false;                 // true if _muxTimer is armed
+static uint32_t   _muxScheduledFor = 0;                  // deadline _muxTimer is currently armed for
+static bool       _muxDispatching = false;               // true while _ESPMuxHandler is calling timers
+static ESPTimer*  _muxHeap[SYST_ESP_MUX_TIMERS] = { nullptr };
+static int16_t    _muxCount = 0;
+
+// wrap-safe deadline comparison
+static inline bool _muxBefore(const uint32_t a, const uint32_t b) {
+   return static_cast<int32_t>(a - b) < 0;
+}
+
+void _ESPMuxPlace(ESPTimer* that, const int16_t pos) {
+   _muxHeap[pos] = that;
+   that->_heapPos = pos;
+}
+
+void _ESPMuxSiftUp(int16_t pos) {
+   ESPTimer* that = _muxHeap[pos];
+   while (pos > 0) {
+      int16_t parent = (pos - 1) / 2;
+      if (!_muxBefore(that->_deadline, _muxHeap[parent]->_deadline)) {
+         break;
+      }
+      _ESPMuxPlace(_muxHeap[parent], pos);
+      pos = parent;
+   }
+   _ESPMuxPlace(that, pos);
+}
+
+void _ESPMuxSiftDown(int16_t pos) {
+   ESPTimer* that = _muxHeap[pos];
+   while (true) {
+      int16_t child = (2 * pos) + 1;
+      if (child >= _muxCount) {
+         break;
+      }
+      if (((child + 1) < _muxCount) && _muxBefore(_muxHeap[child + 1]->_deadline, _muxHeap[child]->_deadline)) {
+         ++child;
+      }
+      if (!_muxBefore(_muxHeap[child]->_deadline, that->_deadline)) {
+         break;
+      }
+      _ESPMuxPlace(_muxHeap[child], pos);
+      pos = child;
+   }
+   _ESPMuxPlace(that, pos);
+}
+
+// remove the timer at the given heap position
+void _ESPMuxRemove(int16_t pos) {
+   ESPTimer* that = _muxHeap[pos];
+   ESPTimer* last = _muxHeap[--_muxCount];
+
+   that->_heapPos = -1;
+   _muxHeap[_muxCount] = nullptr;
+   if (pos < _muxCount) {
+      _ESPMuxPlace(last, pos);
+      _ESPMuxSiftDown(pos);
+      _ESPMuxSiftUp(last->_heapPos);
+   }
+}
+
+// drop every disarmed timer from the heap and rebuild it, when it is full
+void _ESPMuxCollect(void) {
+   int16_t kept = 0;
+
+   SYST_LOCK();
+   for (int16_t i = 0; i < _muxCount; i++) {
+      if (_muxHeap[i]->_armed) {
+         _ESPMuxPlace(_muxHeap[i], kept++);
+      } else {
+         _muxHeap[i]->_heapPos = -1;
+      }
+   }
+   for (int16_t i = kept; i < _muxCount; i++) {
+      _muxHeap[i] = nullptr;
+   }
+   _muxCount = kept;
+   for (int16_t i = (kept / 2) - 1; i >= 0; i--) {
+      _ESPMuxSiftDown(i);
+   }
+   SYST_UNLOCK();
+}
+
+/*
+arm the shared os_timer for the earliest deadline in the heap, but only if it is not already armed for it:
+re-arming walks the SDK timer list, so several arm() calls that do not change the earliest deadline cost nothing here
+
+while the handler is calling timers, nothing is done: the handler reschedules once when it has finished, so any
+number of arm() and retune calls made from callbacks share a single os_timer re-arm
+
+disarmed timers at the top of the heap are dropped first, so the os_timer is not armed for them
+*/
+void _ESPMuxReschedule(const uint32_t now) {
+   if (_muxDispatching) {
+      return;
+   }
+   {
+      SYST_LOCK();
+      while ((_muxCount > 0) && !_muxHeap[0]->_armed) {
+         _ESPMuxRemove(0);
+      }
+      SYST_UNLOCK();
+   }
+   if (_muxCount == 0) {
+      if (_muxScheduled) {
+         os_timer_disarm(&_muxTimer);
+         _muxScheduled = false;
+      }
+   } else {
+      uint32_t deadline = _muxHeap[0]->_deadline;
+      if (!_muxScheduled || (deadline != _muxScheduledFor)) {
+         int32_t delay = static_cast<int32_t>(deadline - now);
+         os_timer_disarm(&_muxTimer);
+         os_timer_arm(&_muxTimer, (delay > 0) ? delay : 1, false);
+         _muxScheduled = true;
+         _muxScheduledFor = deadline;
+      }
+   }
+}
+
+/*
+shared os_timer callback: call every timer that is due
+
+repeating timers are put back in the heap before the user callback is called, so the callback may safely
+disarm or re-arm its own timer (or any other)
+
+the clock is read once for the whole pass: every timer called in it was due at now, so its period started then,
+however long the callbacks before it took
+*/
+void _ESPMuxHandler(void* arg) {
+   (void)arg;
+   uint32_t now = millis();
+   uint32_t periodStart = micros();
+
+   _muxScheduled = false;                            // os_timer is one-shot, so it is no longer armed
+   _muxDispatching = true;
+   while ((_muxCount > 0) && !_muxBefore(now, _muxHeap[0]->_deadline)) {
+      ESPTimer* that = _muxHeap[0];
+      SYST_LOCK();                                           // a disarm() from an interrupt lands before or after this
+      if (!that->_armed) {
+         _ESPMuxRemove(0);                                   // disarmed since it was scheduled
+         SYST_UNLOCK();
+         continue;
+      }
+      if (that->_oneshot) {
+         _ESPMuxRemove(0);
+         that->_oneshot = false;
+         that->_armed = false;
+      } else {
+         that->_deadline += that->_interval;
+         if (!_muxBefore(now, that->_deadline)) {
+            // we have fallen more than a period behind, so skip the missed callbacks rather than firing them in a burst
+            that->_deadline = now + that->_interval;
+         }
+         _ESPMuxSiftDown(0);
+      }
+      SYST_UNLOCK();
+      that->_periodStart = periodStart;
+      ++that->_fireCount;
+      (*(that->_callback))(that->_callbackArg);
+   }
+   _muxDispatching = false;
+   _ESPMuxReschedule(millis());
+}
+
+/*
+(re)schedule the timer for one interval from now
+
+returns false if the heap is full
+*/
+bool _ESPMuxArm(ESPTimer* that) {
+   uint32_t now = millis();
+
+   if (!_muxTimerInit) {
+      os_timer_setfn(&_muxTimer, _ESPMuxHandler, nullptr);
+      _muxTimerInit = true;
+   }
+   that->_deadline = now + that->_interval;
+   if (that->_heapPos >= 0) {
+      // already scheduled: the deadline may have moved either way
+      _ESPMuxSiftUp(that->_heapPos);
+      _ESPMuxSiftDown(that->_heapPos);
+   } else {
+      if (_muxCount == SYST_ESP_MUX_TIMERS) {
+         _ESPMuxCollect();
+         if (_muxCount == SYST_ESP_MUX_TIMERS) {
+            return false;
+         }
+      }
+      _ESPMuxPlace(that, _muxCount++);
+      _ESPMuxSiftUp(that->_heapPos);
+   }
+   _ESPMuxReschedule(now);
+   return true;
+}
+
+/*
+move the next deadline of an armed timer by the change in interval: when called from the callback the deadline
+has already been advanced by the old interval, so the next callback is due one new interval after this one
+*/
+void _ESPMuxRetune(ESPTimer* that, const uint32_t msec) {
+   if (that->_heapPos >= 0) {
+      that->_deadline += msec - that->_interval;
+      _ESPMuxSiftUp(that->_heapPos);
+      _ESPMuxSiftDown(that->_heapPos);
+   }
+   that->_interval = msec;
+   _ESPMuxReschedule(millis());
+}
+
+// allows us to emulate use of "this" in the FRC1 interrupt handler
+ESPHWTimer* _ESPHWTimerTable[SYST_ESP_HW_TIMERS] = { nullptr };
+
+static bool _FRC1Enabled = false;                   // true once FRC1 has been set up with our handler
+
+/*
+reload FRC1 with the time remaining to the earliest deadline of all armed timers, or stop it if none are armed
+
+a timer whose callback is running is left out of the earliest deadline, as _ESPHWFire() will not call it until
+the callback returns: if its deadline has passed, counting it would reload FRC1 with the minimum interval over and
+over while a callback that has re-enabled interrupts runs. It still keeps FRC1 running, and the handler that called
+it reschedules FRC1 for its deadline once the callback has returned
+
+must be called with interrupts disabled
+*/
+void ICACHE_RAM_ATTR _ESPHWSchedule(const uint32_t now) {
+   bool     pending = false;
+   uint32_t next = SYST_ESP_HW_MAX_INTERVAL;
+
+   for (uint8_t i = 0; i < SYST_ESP_HW_TIMERS; i++) {
+      ESPHWTimer* that = _ESPHWTimerTable[i];
+      if ((that != nullptr) && that->_armed && that->_inCallback) {
+         pending = true;
+      } else if ((that != nullptr) && that->_armed) {
+         int32_t remaining = static_cast<int32_t>(that->_deadline - now);       // wrap-safe difference
+         if (remaining < SYST_ESP_HW_MIN_INTERVAL) {
+            remaining = SYST_ESP_HW_MIN_INTERVAL;
+         }
+         if (static_cast<uint32_t>(remaining) < next) {
+            next = remaining;
+         }
+         pending = true;
+      }
+   }
+   if (pending) {
+      timer1_write(next * SYST_ESP_HW_TICKS_PER_USEC);
+   } else {
+      timer1_disable();
+      _FRC1Enabled = false;
+   }
+}
+
+/*
+call every timer that is due, starting from the time now
+
+once a callback has run, now is out of date: a timer that does not look due yet is checked again against a fresh
+reading, so one that fell due while an earlier callback ran is called in this pass rather than waiting for a reload.
+Timers that were already due cost no extra reads. Returns the time, read again if any callback ran since
+
+A callback that re-enables interrupts and re-arms a timer can let FRC1 interrupt it, so a timer whose callback is
+already running is left until the next pass rather than called from inside itself
+*/
+uint32_t ICACHE_RAM_ATTR _ESPHWFire(uint32_t now) {
+   bool stale = false;                                      // a callback has run since now was read
+
+   for (uint8_t i = 0; i < SYST_ESP_HW_TIMERS; i++) {
+      ESPHWTimer* that = _ESPHWTimerTable[i];
+      if ((that == nullptr) || !that->_armed || that->_inCallback) {
+         continue;
+      }
+      if (stale && (static_cast<int32_t>(now - that->_deadline) < 0)) {
+         now = micros();
+         stale = false;
+      }
+      if (static_cast<int32_t>(now - that->_deadline) >= 0) {
+         if (that->_oneshot) {
+            that->_oneshot = false;
+            that->_armed = false;
+         } else {
+            that->_deadline += that->_period;
+            if (static_cast<int32_t>(now - that->_deadline) >= 0) {
+               // we have fallen more than a period behind, so skip the missed callbacks rather than firing them in a burst
+               that->_deadline = now + that->_period;
+            }
+         }
+         ++that->_fireCount;
+         that->_inCallback = true;
+         (*(that->_callback))(that->_callbackArg);
+         that->_inCallback = false;
+         stale = true;
+      }
+   }
+   return stale ? micros() : now;
+}
+
+/*
+FRC1 interrupt handler: call every timer that is due, then reload FRC1 for the next earliest deadline
+
+The deadline is checked rather than assumed, since FRC1 may have been loaded with a partial interval
+(either the 23-bit counter limit or an earlier deadline that has since been disarmed)
+
+Deadlines are absolute, so the time taken by the callbacks does not accumulate. If the next deadline is within
+SYST_ESP_HW_SPIN usec, we wait for it here: a reload that short would be overrun by the interrupt exit and entry,
+and the callback would be late by the minimum interval instead. This is done once per interrupt, so a burst of
+close deadlines cannot hold the handler indefinitely
+
+every deadline comparison after a callback is made against a fresh reading (see _ESPHWFire), but the reading is
+shared by the comparisons that no callback separates
+*/
+void ICACHE_RAM_ATTR _ESPHWCommonHandler(void) {
+   bool     pending = false;
+   uint32_t next = 0;
+   uint32_t now;
+
+   now = _ESPHWFire(micros());
+   for (uint8_t i = 0; i < SYST_ESP_HW_TIMERS; i++) {
+      ESPHWTimer* that = _ESPHWTimerTable[i];
+      if ((that != nullptr) && that->_armed && !that->_inCallback &&
+          (!pending || (static_cast<int32_t>(that->_deadline - next) < 0))) {
+         next = that->_deadline;
+         pending = true;
+      }
+   }
+   if (pending && (static_cast<int32_t>(next - now) <= SYST_ESP_HW_SPIN)) {
+      while (static_cast<int32_t>(now - next) < 0) {
+         now = micros();
+      }
+      now = _ESPHWFire(now);
+   }
+   _ESPHWSchedule(now);                                     // the callbacks of this pass have returned, so their timers count again
+}
+
+/*
+set the deadline for this timer, mark it armed and reschedule FRC1 in case this is now the earliest deadline
+
+the deadline and the armed flag are set in the same critical section, so the FRC1 ISR never sees the timer armed
+with the deadline of an earlier arm. Like retuneHWTimer, this restores the interrupt level, so it may be called from a callback
+*/
+void ICACHE_RAM_ATTR startHWTimer(const uint8_t timerNum, const uint32_t usec) {
+   ESPHWTimer* that = _ESPHWTimerTable[timerNum];
+   uint32_t    savedPS = xt_rsil(15);
+   uint32_t    now = micros();
+
+   that->_period = constrain(usec, SYST_ESP_HW_MIN_INTERVAL, 0x7FFFFFFFUL);
+   that->_deadline = now + that->_period;
+   that->_armed = true;
+   if (!_FRC1Enabled) {
+      timer1_isr_init();
+      timer1_attachInterrupt(_ESPHWCommonHandler);
+      timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+      _FRC1Enabled = true;
+   }
+   _ESPHWSchedule(now);
+   xt_wsr_ps(savedPS);
+}
+
+/*
+change the period of an armed timer, moving its next deadline by the difference
+uses the saved interrupt level rather than noInterrupts() since this may be called from the callback (i.e. in the ISR)
+*/
+void ICACHE_RAM_ATTR retuneHWTimer(const uint8_t timerNum, const uint32_t usec) {
+   ESPHWTimer* that = _ESPHWTimerTable[timerNum];
+   uint32_t    period = constrain(usec, SYST_ESP_HW_MIN_INTERVAL, 0x7FFFFFFFUL);
+   uint32_t    savedPS = xt_rsil(15);
+
+   that->_deadline += period - that->_period;
+   that->_period = period;
+   if (_FRC1Enabled) {
+      _ESPHWSchedule(micros());
+   }
+   xt_wsr_ps(savedPS);
+}
+
+/*
+the timer has already been marked as disarmed, so just reschedule FRC1 for whatever remains
+like retuneHWTimer, this restores the interrupt level so that a timer can be disarmed from its callback
+*/
+void ICACHE_RAM_ATTR stopHWTimer(const uint8_t timerNum) {
+   (void)timerNum;
+   uint32_t savedPS = xt_rsil(15);
+
+   if (_FRC1Enabled) {
+      _ESPHWSchedule(micros());
+   }
+   xt_wsr_ps(savedPS);
+}
+
+#endif
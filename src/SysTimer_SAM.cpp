@@ -23,20 +23,66 @@ To view a copy of this license, visit https://creativecommons.org/licenses/by-sa
 int8_t SysTimerBase::_index = 0;                    // static class member initialization
 
 #if defined(__SAM3X8E__)
-#ifndef USING_SERVO_LIB
-   /*
-    the DueTimer library pre-instantiates the Timer objects 0:7
-    0, 2, 3, 4, and 5 are not available if the Servo library (Servo.h) is used
+/*
+ the DueTimer library pre-instantiates the Timer objects 0:8
+ 2, 3, 4, and 5 are not available if the Servo library (Servo.h) is used, and in that case timer 0 is named "Timer"
+ rather than "Timer0", so we use "Timer" here in all cases
 
-    table of interrupt handlers for the DueTimer isr function (this one does not accept an argument to the ISR)
-   */
-   CallbackFunc _SAMCallbackTable[] = { &_isrSAM0, &_isrSAM1, &_isrSAM2, &_isrSAM3, &_isrSAM4, &_isrSAM5, &_isrSAM6, &_isrSAM7, &_isrSAM8 };
+ (the reserved timers are never allocated, so their entries are never used)
+*/
+#ifndef USING_SERVO_LIB
+DueTimer* _SAMDueTimers[SYST_SAM_SLOTS] = { &Timer, &Timer1, &Timer2, &Timer3, &Timer4, &Timer5, &Timer6, &Timer7, &Timer8 };
 #else
-   CallbackFunc _SAMCallbackTable[] = { &_isrSAM0, &_isrSAM1, &_isrSAM6, &_isrSAM7, &_isrSAM8 }; // refers to Timer, not Timer0 in DueTimer.cpp, but 0 used here for consistency
+DueTimer* _SAMDueTimers[SYST_SAM_SLOTS] = { &Timer, &Timer1, nullptr, nullptr, nullptr, nullptr, &Timer6, &Timer7, &Timer8 };
 #endif
 
+// TC module and channel for each of the DueTimer timers (the same mapping the DueTimer library uses)
+struct SAMTimerChannel {
+   Tc*        tc;
+   uint32_t   channel;
+   IRQn_Type  irq;
+   int8_t     tioaPin;                              // Arduino pin number of TIOA, or -1 if not broken out on the Due
+};
+
+static const SAMTimerChannel _SAMChannels[SYST_SAM_SLOTS] = {
+   { TC0, 0, TC0_IRQn, 2 },  { TC0, 1, TC1_IRQn, -1 }, { TC0, 2, TC2_IRQn, -1 },
+   { TC1, 0, TC3_IRQn, -1 }, { TC1, 1, TC4_IRQn, -1 }, { TC1, 2, TC5_IRQn, -1 },
+   { TC2, 0, TC6_IRQn, 5 },  { TC2, 1, TC7_IRQn, 3 },  { TC2, 2, TC8_IRQn, 11 }
+};
+
+static void _isrSAM0 (void);
+static void _isrSAM1 (void);
+static void _isrSAM2 (void);
+static void _isrSAM3 (void);
+static void _isrSAM4 (void);
+static void _isrSAM5 (void);
+static void _isrSAM6 (void);
+static void _isrSAM7 (void);
+static void _isrSAM8 (void);
+
+// table of interrupt handlers for the DueTimer isr function (this one does not accept an argument to the ISR)
+CallbackFunc _SAMCallbackTable[SYST_SAM_SLOTS] = { &_isrSAM0, &_isrSAM1, &_isrSAM2, &_isrSAM3, &_isrSAM4, &_isrSAM5, &_isrSAM6, &_isrSAM7, &_isrSAM8 };
+
 // allows us to emulate use of "this" in the interrupt handlers referenced through the above callback table
-SAMTimer*    _SAMTimerTable[SYST_MAX_TIMERS] = { nullptr };
+SAMTimer*    _SAMTimerTable[SYST_SAM_SLOTS] = { nullptr };
+SysCapture*  _SysCaptureTable[SYST_SAM_SLOTS] = { nullptr };
+
+static uint16_t _SAMSlotsInUse = 0;                 // bitmap of allocated timers
+
+/*
+allocate the first free timer that is not reserved for another library
+
+returns -1 if there are none left
+*/
+int8_t allocTimer(const uint16_t reserved) {
+   for (uint8_t slot = 0; slot < SYST_SAM_SLOTS; slot++) {
+      if (!((_SAMSlotsInUse | reserved) & bit(slot))) {
+         _SAMSlotsInUse |= bit(slot);
+         return slot;
+      }
+   }
+   return -1;
+}
 
 /*
  Shim ISR that associates the interrupt with the initiatiating timer object and the calls the user's callback function
@@ -48,54 +94,187 @@ SAMTimer*    _SAMTimerTable[SYST_MAX_TIMERS] = { nullptr };
 void _SAMCommonHandler(SAMTimer* that) {
    noInterrupts();
    if (that->_repeating || that->_oneshot) {
+      if (that->_oneshot) {
+         // the TC has already stopped itself (CPCSTOP), so we only need to update the state, before the callback so it can re-arm
+         that->_oneshot = false;
+         that->_armed = false;
+      }
+      ++that->_fireCount;
       auto callback = std::bind(that->_callback, that->_callbackArg);              // VS2017 IntelliSense complains but gcc accepts this
       callback();
       //that->_callback(that->_callbackArg);                                       // this also works
    }
-   if (that->_oneshot) {
-      that->_oneshot = false;
-      that->disarm(); 
-   }
    interrupts();
 }
 
+/*
+set or clear CPCSTOP, which stops the counter clock on the RC compare match
+
+DueTimer::start() has just configured the channel in waveform mode with RC compare, so we only change this one bit
+*/
+void setStopOnCompare(const uint8_t timerNum, const bool stop) {
+   const SAMTimerChannel& t = _SAMChannels[timerNum];
+
+   if (stop) {
+      t.tc->TC_CHANNEL[t.channel].TC_CMR |= TC_CMR_CPCSTOP;
+   } else {
+      t.tc->TC_CHANNEL[t.channel].TC_CMR &= ~TC_CMR_CPCSTOP;
+   }
+}
+
+/*
+read the position within the current period from the TC counter value (CV) and RC compare register
+
+DueTimer selects the TC clock to suit the frequency, so we decode the clock selection from the mode register
+in waveform mode with RC compare, CV restarts from 0 on the compare, so it is correct even if the interrupt is pending
+*/
+static uint32_t _SAMClockFrequency(const uint32_t mode) {
+   static const uint32_t divisors[] = { 2, 8, 32, 128 };
+   uint32_t clock = mode & 0x07;                                             // TCCLKS
+
+   return (clock < 4) ? (VARIANT_MCK / divisors[clock]) : 32768;             // TIMER_CLOCK5 is the slow clock
+}
+
+void timerPosition(const uint8_t timerNum, uint32_t& elapsed, uint32_t& period) {
+   const SAMTimerChannel& t = _SAMChannels[timerNum];
+
+   SYST_LOCK();
+   uint32_t count = t.tc->TC_CHANNEL[t.channel].TC_CV;
+   uint32_t top = t.tc->TC_CHANNEL[t.channel].TC_RC;
+   uint32_t mode = t.tc->TC_CHANNEL[t.channel].TC_CMR;
+   SYST_UNLOCK();
+
+   uint32_t frequency = _SAMClockFrequency(mode);
+   elapsed = static_cast<uint32_t>((static_cast<uint64_t>(count) * 1000000ULL) / frequency);
+   period = static_cast<uint32_t>((static_cast<uint64_t>(top) * 1000000ULL) / frequency);
+}
+
+/*
+change the period by rewriting RC with the TC clock DueTimer selected when the timer was started
+
+the new RC applies to the period in progress, so when called from the callback (CV near 0) the next interrupt is one
+new period after this one. If the counter has already passed the new RC it would run on to wrap around, so we restart
+the period instead
+
+returns false if the interval cannot be reached with the current clock
+*/
+bool retuneTimer(const uint8_t timerNum, const uint32_t usec) {
+   const SAMTimerChannel& t = _SAMChannels[timerNum];
+   uint32_t primask = __get_PRIMASK();
+
+   __disable_irq();                                                          // may be called from the callback
+   uint64_t top = (static_cast<uint64_t>(usec) * _SAMClockFrequency(t.tc->TC_CHANNEL[t.channel].TC_CMR)) / 1000000ULL;
+   bool     valid = (top >= 2) && (top <= 0xFFFFFFFFULL);
+   if (valid) {
+      t.tc->TC_CHANNEL[t.channel].TC_RC = static_cast<uint32_t>(top);
+      if (t.tc->TC_CHANNEL[t.channel].TC_CV >= top) {
+         t.tc->TC_CHANNEL[t.channel].TC_CCR = TC_CCR_SWTRG;
+      }
+   }
+   __set_PRIMASK(primask);
+   return valid;
+}
+
+/*
+ capture ISR: DueTimer's TC handler has already read (and so cleared) the status register, but we only enable the
+ RA load interrupt, so each interrupt means RA holds a new timestamp
+*/
+static void _SAMCaptureISR(const uint8_t timerNum) {
+   const SAMTimerChannel& t = _SAMChannels[timerNum];
+   _SysCaptureHandler(_SysCaptureTable[timerNum], t.tc->TC_CHANNEL[t.channel].TC_RA);
+}
+
+// route the DueTimer callback to whichever object owns the timer
+static inline void _SAMDispatch(const uint8_t timerNum) {
+   if (_SysCaptureTable[timerNum] != nullptr) {
+      _SAMCaptureISR(timerNum);
+   } else {
+      _SAMCommonHandler(_SAMTimerTable[timerNum]);
+   }
+}
+
 // declare these as static to limit their scope to this exeuction unit (for a "C" function)
 static void _isrSAM0 (void) {
-   _SAMCommonHandler(_SAMTimerTable[0]);
+   _SAMDispatch(0);
 }
 
 static void _isrSAM1 (void) {
-   _SAMCommonHandler(_SAMTimerTable[1]);
+   _SAMDispatch(1);
 }
 
-#ifndef USING_SERVO_LIB
 static void _isrSAM2 (void) {
-   _SAMCommonHandler(_SAMTimerTable[2]);
+   _SAMDispatch(2);
 }
 
 static void _isrSAM3 (void) {
-   _SAMCommonHandler(_SAMTimerTable[3]);
+   _SAMDispatch(3);
 }
 
 static void _isrSAM4 (void) {
-   _SAMCommonHandler(_SAMTimerTable[4]);
+   _SAMDispatch(4);
 }
 
 static void _isrSAM5 (void) {
-   _SAMCommonHandler(_SAMTimerTable[5]);
+   _SAMDispatch(5);
 }
-#endif
 
 static void _isrSAM6 (void) {
-   _SAMCommonHandler(_SAMTimerTable[6]);
+   _SAMDispatch(6);
 }
 
 static void _isrSAM7 (void) {
-   _SAMCommonHandler(_SAMTimerTable[7]);
+   _SAMDispatch(7);
 }
 
 static void _isrSAM8 (void) {
-   _SAMCommonHandler(_SAMTimerTable[8]);
+   _SAMDispatch(8);
+}
+
+/*
+put the TC channel in capture mode, clocked at MCK/2, loading RA on the selected edge(s) of TIOA,
+and route the TIOA pin to the TC (peripheral B on all of the capture pins)
+*/
+bool startCapture(const uint8_t timerNum, const CaptureEdge edge) {
+   const SAMTimerChannel& t = _SAMChannels[timerNum];
+   uint32_t loadEdge;
+
+   if (t.tioaPin < 0) {
+      return false;
+   }
+   switch (edge) {
+   case CaptureEdge::C_FALLING:
+      loadEdge = TC_CMR_LDRA_FALLING;
+      break;
+   case CaptureEdge::C_BOTH:
+      loadEdge = TC_CMR_LDRA_EDGE;
+      break;
+   default:
+      loadEdge = TC_CMR_LDRA_RISING;
+      break;
+   }
+   PIO_Configure(g_APinDescription[t.tioaPin].pPort, PIO_PERIPH_B, g_APinDescription[t.tioaPin].ulPin, PIO_DEFAULT);
+   pmc_set_writeprotect(false);
+   pmc_enable_periph_clk(static_cast<uint32_t>(t.irq));
+   TC_Configure(t.tc, t.channel, TC_CMR_TCCLKS_TIMER_CLOCK1 | loadEdge);
+   t.tc->TC_CHANNEL[t.channel].TC_IER = TC_IER_LDRAS;
+   t.tc->TC_CHANNEL[t.channel].TC_IDR = ~TC_IER_LDRAS;
+   _SAMDueTimers[timerNum]->attachInterrupt(_SAMCallbackTable[timerNum]);
+   NVIC_ClearPendingIRQ(t.irq);
+   NVIC_EnableIRQ(t.irq);
+   TC_Start(t.tc, t.channel);
+   return true;
+}
+
+void stopCapture(const uint8_t timerNum) {
+   const SAMTimerChannel& t = _SAMChannels[timerNum];
+
+   NVIC_DisableIRQ(t.irq);
+   TC_Stop(t.tc, t.channel);
+   t.tc->TC_CHANNEL[t.channel].TC_IDR = 0xFFFFFFFF;
+}
+
+int8_t capturePin(const uint8_t timerNum) {
+   return _SAMChannels[timerNum].tioaPin;
 }
 
 #endif
@@ -0,0 +1,151 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#include <SysWatchdog.h>
+
+#if defined(__AVR__)
+#include <avr/wdt.h>
+#endif
+
+#define STALL_MAGIC       0x5354414CUL           // "STAL", mixed with the record so that random memory after power up is not mistaken for it
+
+/*
+the stall record: magic, pc, uptime and checkpoint, one word each
+
+AVR: RAM in the .noinit section, which the C runtime does not clear on reset
+SAM: the last 4 of the 8 general purpose backup registers, which keep their contents over a reset while VDDBU is powered
+ESP8266: the last 4 words of the RTC user memory (blocks 188-191), clear of the area used by OTA updates. These are
+written directly rather than with system_rtc_mem_write(), which is not safe to call from an interrupt handler
+*/
+#if defined(__AVR__)
+static volatile uint32_t _stallStore[4] __attribute__((section(".noinit")));
+#define STALL_STORE       (_stallStore)
+#elif defined(__SAM3X8E__)
+#define STALL_STORE       (&GPBR->SYS_GPBR[4])
+#elif defined(ESP8266)
+#define STALL_STORE       (reinterpret_cast<volatile uint32_t*>(0x600012F0UL))
+#endif
+
+/*
+reset the board
+
+AVR: let the hardware watchdog time out. The bootloader must disable it after the reset (Optiboot does)
+SAM: reset the processor and peripherals through the reset controller
+ESP8266: spin with interrupts disabled until the ESP8266's own hardware watchdog resets it
+*/
+static void SYST_ISR_ATTR resetBoard(void) {
+#if defined(__AVR__)
+   wdt_enable(WDTO_15MS);
+#elif defined(__SAM3X8E__)
+   RSTC->RSTC_CR = RSTC_CR_KEY(0xA5) | RSTC_CR_PROCRST | RSTC_CR_PERRST;
+#endif
+   while (true) {}
+}
+
+/*
+timer callback: if loop() has not kicked the watchdog for a whole timeout, record where it was
+*/
+void SYST_ISR_ATTR _SysWatchdogHandler(void* arg) {
+   SysWatchdog* that = static_cast<SysWatchdog*>(arg);
+
+   that->_count = that->_count + 1;
+   if (that->_count <= SYST_WATCHDOG_TICKS) {
+      return;
+   }
+
+   volatile uint32_t* store = STALL_STORE;
+   uint32_t           pc = sysInterruptedPC();
+   uint32_t           uptime = millis();
+   uint16_t           checkpoint = that->_checkpoint;
+
+   store[1] = pc;
+   store[2] = uptime;
+   store[3] = checkpoint;
+   store[0] = STALL_MAGIC ^ pc ^ uptime ^ checkpoint;            // written last, so a half written record is not valid
+   if (that->_reset) {
+      resetBoard();
+   }
+   that->_count = 0;
+   that->_stalls = that->_stalls + 1;
+}
+
+/*
+start the watchdog: loop() must call kick() at least once every timeoutMs msec. If reset is false, the stall is
+recorded and counted, but the board is not reset
+
+the timer ticks SYST_WATCHDOG_TICKS times per timeout, so a stall is detected between timeoutMs and
+timeoutMs * (SYST_WATCHDOG_TICKS + 1) / SYST_WATCHDOG_TICKS msec after the last kick
+*/
+bool SysWatchdog::begin(const uint32_t timeoutMs, const bool reset) {
+   uint32_t tickMs = timeoutMs / SYST_WATCHDOG_TICKS;
+
+   if (!_timer.begin() || (timeoutMs == 0)) {
+      return false;
+   }
+   _reset = reset;
+   _count = 0;
+   _timer.attachInterrupt(_SysWatchdogHandler, this);
+   _timer.setInterval((tickMs > 0) ? tickMs : 1);
+   return _timer.arm(true);
+}
+
+void SysWatchdog::end(void) {
+   _timer.disarm();
+}
+
+/*
+get the stall recorded before the last reset, if there was one, and clear it: call this in setup()
+
+returns false if there is no record
+*/
+bool SysWatchdog::lastStall(SysStallRecord& record) {
+   volatile uint32_t* store = STALL_STORE;
+
+   noInterrupts();
+   uint32_t magic = store[0];
+   uint32_t checkpoint = store[3];
+   record.pc = store[1];
+   record.uptime = store[2];
+   record.checkpoint = checkpoint;
+   store[0] = 0;
+   interrupts();
+   return magic == (STALL_MAGIC ^ record.pc ^ record.uptime ^ checkpoint);
+}
+
+/*
+print the stall recorded before the last reset, if there was one, and clear it
+
+returns false if there is no record
+*/
+bool SysWatchdog::report(Print& out) {
+   SysStallRecord record;
+
+   if (!lastStall(record)) {
+      return false;
+   }
+   out.print("loop() stalled at checkpoint ");
+   out.print(static_cast<unsigned long>(record.checkpoint));
+   out.print(", pc 0x");
+   out.print(static_cast<unsigned long>(record.pc), HEX);
+   out.print(", uptime ");
+   out.print(static_cast<unsigned long>(record.uptime));
+   out.println(" msec");
+   return true;
+}
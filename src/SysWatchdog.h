@@ -0,0 +1,91 @@
+/*
+SysTimer: a timer abstraction library that provides a simple and consistent API across a variety of platforms
+https://github.com/Rom3oDelta7/SysTimer
+
+Currently supports:
+  * ESP8266
+  * AVR platforms (Uno, Mega, Nano, Pro Micro, Teensy, etc.)
+  * SAM platforms (Due)
+
+This library utilizes the following libraries for the actual timer implementation:
+ESP: internal
+DueTimer: https://github.com/ivanseidel/DueTimer
+AVR: internal
+
+
+Copyright 2017 Rob Redford
+This work is licensed under the Creative Commons Attribution-ShareAlike 4.0 (CC BY-SA 4.0) International License.
+To view a copy of this license, visit https://creativecommons.org/licenses/by-sa/4.0
+*/
+
+#ifndef _SysWatchdog_H_
+#define _SysWatchdog_H_
+
+#include <SysTimer.h>
+#include <SysPort.h>
+
+#define SYST_WATCHDOG_TICKS    4                 // timer ticks per timeout
+
+// mark the place in loop() that was last reached, using the line number as the tag
+#define SYST_CHECKPOINT(watchdog)    (watchdog).checkpoint(__LINE__)
+
+/*
+where loop() was when it stalled
+
+pc is a byte address, as used in the map file and by addr2line (0 if it could not be found), and uptime is millis()
+when the stall was detected
+*/
+struct SysStallRecord {
+   uint32_t pc;
+   uint32_t uptime;
+   uint16_t checkpoint;
+};
+
+/*
+a software watchdog for loop()
+
+loop() must call kick() at least once every timeoutMs. If it does not, the timer callback records the address that it
+interrupted (i.e. where loop() is stuck) and the last checkpoint, in memory that is not cleared by a reset, and then
+resets the board. lastStall() or report() then tells you where it was on the next boot
+
+the record is kept in a .noinit RAM section on the AVR, the general purpose backup registers on the Due and the RTC
+user memory on the ESP8266
+*/
+class SysWatchdog {
+public:
+   SysWatchdog(SysTimer& timer) : _timer(timer) {}
+
+   bool     begin(const uint32_t timeoutMs, const bool reset = true);
+   void     end(void);
+   bool     lastStall(SysStallRecord& record);
+   bool     report(Print& out);
+
+   void kick(void) {
+      _count = 0;
+   }
+
+   void checkpoint(const uint16_t tag) {
+      SYST_LOCK();
+      _checkpoint = tag;
+      SYST_UNLOCK();
+   }
+
+   // stalls detected with reset disabled
+   uint16_t getStalls(void) const {
+      SYST_LOCK();
+      uint16_t stalls = _stalls;
+      SYST_UNLOCK();
+      return stalls;
+   }
+
+private:
+   SysTimer&            _timer;
+   bool                 _reset = true;
+   volatile uint8_t     _count = 0;                 // ticks since the last kick
+   volatile uint16_t    _checkpoint = 0;
+   volatile uint16_t    _stalls = 0;
+
+   friend void _SysWatchdogHandler(void* arg);
+};
+
+#endif //header protect